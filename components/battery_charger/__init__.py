@@ -2,12 +2,18 @@ CODEOWNERS = ["SqrTT"]
 
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import (sensor, text_sensor)
+from esphome import automation
+from esphome.components import (sensor, text_sensor, output)
+from esphome.core import CORE
 from esphome.const import (
     CONF_ID,
+    CONF_OUTPUT,
+    CONF_MIN_POWER,
+    CONF_MAX_POWER,
     UNIT_VOLT
     
 )
+from ..coulomb_meter import CoulombMeter_ns, preference_hash
 CODEOWNERS = ["SqrTT"]
 
 
@@ -33,42 +39,342 @@ CONF_EQUALIZATION_TIME = 'equalization_time'
 CONF_EQUALIZATION_INTERVAL = 'equalization_interval'
 CONF_EQUALIZATION_TIMEOUT = 'equalization_timeout'
 
+CONF_PROFILE = 'profile'
+
+CONF_SENSOR_TEMPERATURE_ID = 'temperature_sensor'
+CONF_CELLS = 'cells'
+CONF_TEMPERATURE_COMPENSATION = 'temperature_compensation'
+CONF_TEMPERATURE_REFERENCE = 'temperature_reference'
+CONF_TEMPERATURE_MIN = 'temperature_min'
+CONF_TEMPERATURE_MAX = 'temperature_max'
+
+CONF_OUTPUT_CONTROL = 'output_control'
+
+CONF_COULOMB_METER = 'coulomb_meter'
+CONF_ABSORPTION_CHARGE_FACTOR = 'absorption_charge_factor'
+
+CONF_EVENT_LOG = 'event_log'
+CONF_EVENT_LOG_SIZE = 'size'
+CONF_SAVE_INTERVAL = 'save_interval'
+CONF_RESTORE_FROM_FLASH = 'restore_from_flash'
+CONF_CONTROL_INTERVAL = 'control_interval'
+CONF_VOLTAGE_KP = 'voltage_kp'
+CONF_VOLTAGE_KI = 'voltage_ki'
+CONF_CURRENT_LIMIT = 'current_limit'
+CONF_CURRENT_KP = 'current_kp'
+CONF_CURRENT_KI = 'current_ki'
+CONF_SLEW_RATE = 'slew_rate'
+
 charger_ns = cg.esphome_ns.namespace("battery_charger")
 ChargerComponent = charger_ns.class_(
     "ChargerComponent", cg.Component, text_sensor.TextSensor
 )
 
+# Built-in chemistry profiles, voltages are per cell and multiplied by the
+# number of cells of the 12/24/48V bank. Temperature compensation is in
+# mV/°C/cell, temperature limits are charge cut-offs in °C.
+CHEMISTRIES = {
+    'flooded': {
+        'cells': (6, 12, 24),
+        CONF_FLOAT_VOLTAGE_ID: 2.25,
+        CONF_ABSORPTION_VOLTAGE: 2.40,
+        CONF_ABSORPTION_RESTART_VOLTAGE: 2.10,
+        CONF_EQUALIZATION_VOLTAGE: 2.58,
+        CONF_VOLTAGE_MAX: 2.67,
+        CONF_VOLTAGE_MIN: 1.75,
+        CONF_ABSORPTION_TIME: '2h',
+        CONF_EQUALIZATION_TIME: '2h',
+        CONF_EQUALIZATION_INTERVAL: '30d',
+        CONF_EQUALIZATION_TIMEOUT: '4h',
+        CONF_TEMPERATURE_COMPENSATION: -4.0,
+        CONF_TEMPERATURE_MIN: -20.0,
+        CONF_TEMPERATURE_MAX: 50.0,
+    },
+    'agm': {
+        'cells': (6, 12, 24),
+        CONF_FLOAT_VOLTAGE_ID: 2.27,
+        CONF_ABSORPTION_VOLTAGE: 2.40,
+        CONF_ABSORPTION_RESTART_VOLTAGE: 2.10,
+        CONF_VOLTAGE_MAX: 2.55,
+        CONF_VOLTAGE_MIN: 1.75,
+        CONF_ABSORPTION_TIME: '1h',
+        CONF_TEMPERATURE_COMPENSATION: -3.0,
+        CONF_TEMPERATURE_MIN: -20.0,
+        CONF_TEMPERATURE_MAX: 50.0,
+    },
+    'lifepo4': {
+        'cells': (4, 8, 16),
+        CONF_FLOAT_VOLTAGE_ID: 3.375,
+        CONF_ABSORPTION_VOLTAGE: 3.55,
+        CONF_ABSORPTION_RESTART_VOLTAGE: 3.30,
+        CONF_VOLTAGE_MAX: 3.65,
+        CONF_VOLTAGE_MIN: 2.50,
+        CONF_ABSORPTION_TIME: '30min',
+        CONF_TEMPERATURE_MIN: 0.0,
+        CONF_TEMPERATURE_MAX: 45.0,
+    },
+    'nmc': {
+        'cells': (3, 7, 13),
+        CONF_FLOAT_VOLTAGE_ID: 4.05,
+        CONF_ABSORPTION_VOLTAGE: 4.15,
+        CONF_ABSORPTION_RESTART_VOLTAGE: 3.95,
+        CONF_VOLTAGE_MAX: 4.25,
+        CONF_VOLTAGE_MIN: 3.00,
+        CONF_ABSORPTION_TIME: '30min',
+        CONF_TEMPERATURE_MIN: 0.0,
+        CONF_TEMPERATURE_MAX: 45.0,
+    },
+}
+
+PROFILE_VOLTAGE_KEYS = (
+    CONF_FLOAT_VOLTAGE_ID,
+    CONF_ABSORPTION_VOLTAGE,
+    CONF_ABSORPTION_RESTART_VOLTAGE,
+    CONF_EQUALIZATION_VOLTAGE,
+    CONF_VOLTAGE_MAX,
+    CONF_VOLTAGE_MIN,
+)
+
+PROFILE_TIME_KEYS = (
+    CONF_ABSORPTION_TIME,
+    CONF_ABSORPTION_RESTART_TIME,
+    CONF_ABSORPTION_LOW_VOLTAGE_DELAY,
+    CONF_EQUALIZATION_TIME,
+    CONF_EQUALIZATION_INTERVAL,
+    CONF_EQUALIZATION_TIMEOUT,
+    CONF_VOLTAGE_RECOVERY_DELAY,
+)
+
+
+def _build_profiles():
+    profiles = {}
+    for chemistry, params in CHEMISTRIES.items():
+        for nominal, cells in zip((12, 24, 48), params['cells']):
+            profile = {CONF_CELLS: cells}
+            for key, value in params.items():
+                if key == 'cells':
+                    continue
+                if key in PROFILE_VOLTAGE_KEYS:
+                    profile[key] = round(value * cells, 2)
+                elif key in PROFILE_TIME_KEYS:
+                    profile[key] = cv.positive_time_period_seconds(value)
+                else:
+                    profile[key] = value
+            profiles[f"{chemistry}_{nominal}v"] = profile
+    return profiles
+
+
+PROFILES = _build_profiles()
+
+# used when neither the profile nor the yaml sets the field
+PROFILE_DEFAULTS = {
+    CONF_VOLTAGE_RECOVERY_DELAY: '0s',
+    CONF_ABSORPTION_LOW_VOLTAGE_DELAY: '1min',
+    CONF_EQUALIZATION_TIME: '1h',
+    CONF_EQUALIZATION_INTERVAL: '7d',
+    CONF_EQUALIZATION_TIMEOUT: '3h',
+    CONF_TEMPERATURE_COMPENSATION: 0.0,
+    CONF_TEMPERATURE_REFERENCE: 25.0,
+}
+
+# ChargeProfile field order, see charge_profile.h
+PROFILE_FIELDS = (
+    (CONF_FLOAT_VOLTAGE_ID, 'float'),
+    (CONF_ABSORPTION_VOLTAGE, 'float'),
+    (CONF_ABSORPTION_RESTART_VOLTAGE, 'float'),
+    (CONF_ABSORPTION_CURRENT, 'float'),
+    (CONF_ABSORPTION_TIME, 'time'),
+    (CONF_ABSORPTION_RESTART_TIME, 'time'),
+    (CONF_ABSORPTION_LOW_VOLTAGE_DELAY, 'time'),
+    (CONF_EQUALIZATION_VOLTAGE, 'float'),
+    (CONF_EQUALIZATION_TIME, 'time'),
+    (CONF_EQUALIZATION_INTERVAL, 'time'),
+    (CONF_EQUALIZATION_TIMEOUT, 'time'),
+    (CONF_VOLTAGE_MAX, 'float'),
+    (CONF_VOLTAGE_MIN, 'float'),
+    (CONF_VOLTAGE_RECOVERY_DELAY, 'time'),
+    (CONF_CELLS, 'int'),
+    (CONF_TEMPERATURE_COMPENSATION, 'float'),
+    (CONF_TEMPERATURE_REFERENCE, 'float'),
+    (CONF_TEMPERATURE_MIN, 'float'),
+    (CONF_TEMPERATURE_MAX, 'float'),
+)
+
+
+def merge_profile(config):
+    """Fill every field that is not set in yaml from the selected profile, then from the defaults."""
+    config = config.copy()
+    profile = PROFILES.get(config.get(CONF_PROFILE), {})
+    for key, value in profile.items():
+        config.setdefault(key, value)
+    for key, value in PROFILE_DEFAULTS.items():
+        if key not in config:
+            config[key] = cv.positive_time_period_seconds(value) if key in PROFILE_TIME_KEYS else value
+    return config
+
+
+def validate_charge_levels(config):
+    if CONF_FLOAT_VOLTAGE_ID not in config:
+        raise cv.Invalid(f"'{CONF_FLOAT_VOLTAGE_ID}' is required unless a '{CONF_PROFILE}' is selected")
+
+    def below(lower, upper, or_equal=False):
+        if lower not in config or upper not in config:
+            return
+        if config[lower] > config[upper] or (not or_equal and config[lower] == config[upper]):
+            raise cv.Invalid(
+                f"'{lower}' ({config[lower]}V) must be {'at most' if or_equal else 'below'} '{upper}' ({config[upper]}V)",
+                path=[lower],
+            )
+
+    below(CONF_VOLTAGE_MIN, CONF_FLOAT_VOLTAGE_ID)
+    below(CONF_FLOAT_VOLTAGE_ID, CONF_ABSORPTION_VOLTAGE)
+    below(CONF_ABSORPTION_RESTART_VOLTAGE, CONF_ABSORPTION_VOLTAGE)
+    below(CONF_FLOAT_VOLTAGE_ID, CONF_EQUALIZATION_VOLTAGE)
+    below(CONF_ABSORPTION_VOLTAGE, CONF_EQUALIZATION_VOLTAGE, or_equal=True)
+    below(CONF_FLOAT_VOLTAGE_ID, CONF_VOLTAGE_MAX, or_equal=True)
+    below(CONF_ABSORPTION_VOLTAGE, CONF_VOLTAGE_MAX, or_equal=True)
+    below(CONF_EQUALIZATION_VOLTAGE, CONF_VOLTAGE_MAX, or_equal=True)
+
+    if CONF_ABSORPTION_CURRENT in config and config[CONF_ABSORPTION_CURRENT] <= 0:
+        raise cv.Invalid(f"'{CONF_ABSORPTION_CURRENT}' must be positive", path=[CONF_ABSORPTION_CURRENT])
+
+    if config[CONF_TEMPERATURE_COMPENSATION] != 0 and CONF_CELLS not in config:
+        raise cv.Invalid(
+            f"'{CONF_CELLS}' is required for '{CONF_TEMPERATURE_COMPENSATION}' unless a '{CONF_PROFILE}' is selected",
+            path=[CONF_TEMPERATURE_COMPENSATION],
+        )
+    if CONF_TEMPERATURE_MIN in config and CONF_TEMPERATURE_MAX in config and config[CONF_TEMPERATURE_MIN] >= config[CONF_TEMPERATURE_MAX]:
+        raise cv.Invalid(f"'{CONF_TEMPERATURE_MIN}' must be below '{CONF_TEMPERATURE_MAX}'", path=[CONF_TEMPERATURE_MIN])
+    return config
+
+
+OUTPUT_CONTROL_SCHEMA = cv.Schema(
+    {
+        cv.Required(CONF_OUTPUT): cv.use_id(output.FloatOutput),
+        cv.Optional(CONF_CONTROL_INTERVAL, default='10ms'): cv.positive_time_period_milliseconds,
+        cv.Optional(CONF_VOLTAGE_KP, default=0.05): cv.positive_float,
+        cv.Optional(CONF_VOLTAGE_KI, default=0.5): cv.positive_float,
+        cv.Optional(CONF_CURRENT_LIMIT): cv.current,
+        cv.Optional(CONF_CURRENT_KP, default=0.01): cv.positive_float,
+        cv.Optional(CONF_CURRENT_KI, default=0.1): cv.positive_float,
+        # output change per second, 0 disables slew limiting
+        cv.Optional(CONF_SLEW_RATE, default=1.0): cv.positive_float,
+        cv.Optional(CONF_MIN_POWER, default=0.0): cv.percentage,
+        cv.Optional(CONF_MAX_POWER, default=1.0): cv.percentage,
+    }
+)
+
+
+# The ESP8266 keeps all flash preferences in a single 512 byte area, the
+# ring takes 16 bytes per event plus 6, and the other components need room.
+EVENT_LOG_DEFAULT_SIZE = 32
+ESP8266_FLASH_EVENT_LOG_DEFAULT_SIZE = 16
+ESP8266_FLASH_EVENT_LOG_MAX_SIZE = 24
+
+
+def validate_event_log(config):
+    flash_limited = CORE.is_esp8266 and config[CONF_RESTORE_FROM_FLASH]
+    if CONF_EVENT_LOG_SIZE not in config:
+        config[CONF_EVENT_LOG_SIZE] = (
+            ESP8266_FLASH_EVENT_LOG_DEFAULT_SIZE if flash_limited else EVENT_LOG_DEFAULT_SIZE
+        )
+    elif flash_limited and config[CONF_EVENT_LOG_SIZE] > ESP8266_FLASH_EVENT_LOG_MAX_SIZE:
+        raise cv.Invalid(
+            f"At most {ESP8266_FLASH_EVENT_LOG_MAX_SIZE} events can be restored from flash on ESP8266",
+            path=[CONF_EVENT_LOG_SIZE],
+        )
+    return config
+
+
+EVENT_LOG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            # 16 bytes per event, the default depends on the platform
+            cv.Optional(CONF_EVENT_LOG_SIZE): cv.int_range(min=4, max=1024),
+            # saved when entering ERROR, on shutdown and at most every save_interval when it changed
+            cv.Optional(CONF_RESTORE_FROM_FLASH, default=False): cv.boolean,
+            cv.Optional(CONF_SAVE_INTERVAL, default="15min"): cv.All(
+                cv.positive_time_period_milliseconds,
+                cv.Range(min=cv.TimePeriod(minutes=1)),
+            ),
+        }
+    ),
+    validate_event_log,
+)
+
+
+def charge_factor(value):
+    # "102%" or 1.02
+    if isinstance(value, str) and value.strip().endswith('%'):
+        value = cv.float_(value.strip()[:-1]) / 100
+    return cv.float_range(min=1.0, max=1.5)(cv.float_(value))
+
+
+def validate_coulomb_meter(config):
+    if CONF_ABSORPTION_CHARGE_FACTOR in config and CONF_COULOMB_METER not in config:
+        raise cv.Invalid(f"'{CONF_ABSORPTION_CHARGE_FACTOR}' requires '{CONF_COULOMB_METER}'")
+    return config
+
+
+def validate_output_control(config):
+    if CONF_OUTPUT_CONTROL in config:
+        control = config[CONF_OUTPUT_CONTROL]
+        if CONF_CURRENT_LIMIT in control and CONF_SENSOR_CURRENT_ID not in config:
+            raise cv.Invalid(f"'{CONF_CURRENT_LIMIT}' requires '{CONF_SENSOR_CURRENT_ID}'")
+        if control[CONF_MIN_POWER] >= control[CONF_MAX_POWER]:
+            raise cv.Invalid(f"'{CONF_MIN_POWER}' must be below '{CONF_MAX_POWER}'")
+    return config
+
+
 CONFIG_SCHEMA = cv.All(
     cv.Schema(
         {
             cv.GenerateID(): cv.declare_id(ChargerComponent),
             cv.Required(CONF_SENSOR_VOLTAGE_ID): cv.use_id(sensor.Sensor),
-            cv.Required(CONF_FLOAT_VOLTAGE_ID): cv.voltage,
+            cv.Optional(CONF_PROFILE): cv.one_of(*PROFILES, lower=True),
+            cv.Optional(CONF_FLOAT_VOLTAGE_ID): cv.voltage,
             cv.Optional(CONF_TARGET_SENSOR_VOLTAGE): sensor.sensor_schema(
                 unit_of_measurement=UNIT_VOLT,
                 accuracy_decimals=2,
             ),
             cv.Optional(CONF_TARGET_SENSOR_CHARGE_STATE): cv.use_id(text_sensor.TextSensor),
             cv.Optional(CONF_SENSOR_CURRENT_ID): cv.use_id(sensor.Sensor),
+            cv.Optional(CONF_SENSOR_TEMPERATURE_ID): cv.use_id(sensor.Sensor),
+
+            cv.Optional(CONF_CELLS): cv.int_range(min=1, max=255),
+            cv.Optional(CONF_TEMPERATURE_COMPENSATION): cv.float_,
+            cv.Optional(CONF_TEMPERATURE_REFERENCE): cv.temperature,
+            cv.Optional(CONF_TEMPERATURE_MIN): cv.temperature,
+            cv.Optional(CONF_TEMPERATURE_MAX): cv.temperature,
 
             cv.Optional(CONF_VOLTAGE_MAX): cv.voltage,
             cv.Optional(CONF_VOLTAGE_MIN): cv.voltage,
-            cv.Optional(CONF_VOLTAGE_RECOVERY_DELAY, default='0s'): cv.positive_time_period_seconds,
+            cv.Optional(CONF_VOLTAGE_RECOVERY_DELAY): cv.positive_time_period_seconds,
 
             cv.Optional(CONF_ABSORPTION_VOLTAGE): cv.voltage,
             cv.Optional(CONF_ABSORPTION_RESTART_VOLTAGE): cv.voltage,
             cv.Optional(CONF_ABSORPTION_RESTART_TIME): cv.positive_time_period_seconds,
             cv.Optional(CONF_ABSORPTION_CURRENT): cv.current,
             cv.Optional(CONF_ABSORPTION_TIME): cv.positive_time_period_seconds,
-            cv.Optional(CONF_ABSORPTION_LOW_VOLTAGE_DELAY, default= '1min'): cv.positive_time_period_seconds,
+            cv.Optional(CONF_ABSORPTION_LOW_VOLTAGE_DELAY): cv.positive_time_period_seconds,
 
             cv.Optional(CONF_EQUALIZATION_VOLTAGE): cv.voltage,
-            cv.Optional(CONF_EQUALIZATION_TIME, default= "1h"): cv.positive_time_period_seconds,
-            cv.Optional(CONF_EQUALIZATION_INTERVAL, default="7d"): cv.positive_time_period_seconds,
-            cv.Optional(CONF_EQUALIZATION_TIMEOUT, default= '3h'): cv.positive_time_period_seconds,
+            cv.Optional(CONF_EQUALIZATION_TIME): cv.positive_time_period_seconds,
+            cv.Optional(CONF_EQUALIZATION_INTERVAL): cv.positive_time_period_seconds,
+            cv.Optional(CONF_EQUALIZATION_TIMEOUT): cv.positive_time_period_seconds,
+
+            cv.Optional(CONF_OUTPUT_CONTROL): OUTPUT_CONTROL_SCHEMA,
 
+            cv.Optional(CONF_COULOMB_METER): cv.use_id(CoulombMeter_ns),
+            cv.Optional(CONF_ABSORPTION_CHARGE_FACTOR): charge_factor,
+
+            cv.Optional(CONF_EVENT_LOG): EVENT_LOG_SCHEMA,
         }
     ).extend(cv.COMPONENT_SCHEMA),
+    merge_profile,
+    validate_charge_levels,
+    validate_output_control,
+    validate_coulomb_meter,
 )
 
 
@@ -83,54 +389,74 @@ async def to_code(config):
         sensCurrent = await cg.get_variable(config[CONF_SENSOR_CURRENT_ID])
         cg.add(var.set_current_sensor(sensCurrent))
 
+    if CONF_SENSOR_TEMPERATURE_ID in config:
+        sens = await cg.get_variable(config[CONF_SENSOR_TEMPERATURE_ID])
+        cg.add(var.set_temperature_sensor(sens))
+
     if CONF_TARGET_SENSOR_CHARGE_STATE in config:
         sens = await cg.get_variable(config[CONF_TARGET_SENSOR_CHARGE_STATE])
         cg.add(var.set_charge_state_sensor(sens))
     
-    if CONF_VOLTAGE_MAX in config:
-        cg.add(var.set_max_voltage(config[CONF_VOLTAGE_MAX]))
-
-    if CONF_VOLTAGE_MIN in config:
-        cg.add(var.set_min_voltage(config[CONF_VOLTAGE_MIN]))
-
-    if CONF_VOLTAGE_RECOVERY_DELAY in config and config[CONF_VOLTAGE_RECOVERY_DELAY].seconds > 0:
-        cg.add(var.set_voltage_auto_recovery_delay(config[CONF_VOLTAGE_RECOVERY_DELAY]))
-
-    cg.add(var.set_float_voltage(config[CONF_FLOAT_VOLTAGE_ID])) 
-
-    if config.get(CONF_ABSORPTION_VOLTAGE) is not None:
-        cg.add(var.set_absorption_voltage(config[CONF_ABSORPTION_VOLTAGE])) 
-
-        if config.get(CONF_ABSORPTION_CURRENT) is not None:
-            cg.add(var.set_absorption_current(config[CONF_ABSORPTION_CURRENT]))
-
-        if config.get(CONF_ABSORPTION_TIME) is not None:
-            cg.add(var.set_absorption_time(config[CONF_ABSORPTION_TIME]))
-
-        if config.get(CONF_ABSORPTION_RESTART_VOLTAGE) is not None:
-            cg.add(var.set_absorption_restart_voltage(config[CONF_ABSORPTION_RESTART_VOLTAGE]))
-
-        if config.get(CONF_ABSORPTION_RESTART_TIME) is not None:
-            cg.add(var.set_absorption_restart_time(config[CONF_ABSORPTION_RESTART_TIME]))
-
-        if config.get(CONF_ABSORPTION_LOW_VOLTAGE_DELAY) is not None:
-            cg.add(var.set_absorption_low_voltage_delay_s_(config[CONF_ABSORPTION_LOW_VOLTAGE_DELAY]))
-
-    ###
-    if config.get(CONF_EQUALIZATION_VOLTAGE) is not None:
-        cg.add(var.set_equalization_voltage(config[CONF_EQUALIZATION_VOLTAGE]))
-
-        if config.get(CONF_EQUALIZATION_TIME) is not None:
-            cg.add(var.set_equalization_time(config[s]))
-
-        if config.get(CONF_EQUALIZATION_INTERVAL) is not None:
-            cg.add(var.set_equalization_interval(config[s]))
-
-        if config.get(CONF_EQUALIZATION_TIMEOUT) is not None:
-            cg.add(var.set_equalization_timeout(config[CONF_EQUALIZATION_TIMEOUT]))
-
+    # emitted as a constexpr table, the component copies it once in set_profile()
+    fields = []
+    for key, kind in PROFILE_FIELDS:
+        value = config.get(key)
+        if kind == 'time':
+            fields.append(f"    {value.total_seconds if value is not None else 0},  // {key}")
+        elif kind == 'int':
+            fields.append(f"    {value if value is not None else 1},  // {key}")
+        else:
+            fields.append(f"    {f'{value}f' if value is not None else 'NAN'},  // {key}")
+    profile_id = f"{config[CONF_ID].id}_profile"
+    cg.add_global(cg.RawStatement(
+        f"static constexpr esphome::battery_charger::ChargeProfile {profile_id} = {{\n" + "\n".join(fields) + "\n};"
+    ))
+    cg.add(var.set_profile(cg.RawExpression(profile_id)))
 
     if config.get(CONF_TARGET_SENSOR_VOLTAGE) is not None and config[CONF_TARGET_SENSOR_VOLTAGE]:
         sensV = await sensor.new_sensor(config[CONF_TARGET_SENSOR_VOLTAGE])
         cg.add(var.set_voltage_target_sensor(sensV))
-      
+
+    if CONF_COULOMB_METER in config:
+        cg.add_define("USE_BATTERY_CHARGER_COULOMB_METER")
+        meter = await cg.get_variable(config[CONF_COULOMB_METER])
+        cg.add(var.set_coulomb_meter(meter))
+        if CONF_ABSORPTION_CHARGE_FACTOR in config:
+            cg.add(var.set_absorption_charge_factor(config[CONF_ABSORPTION_CHARGE_FACTOR]))
+
+    if event_log := config.get(CONF_EVENT_LOG):
+        cg.add_define("USE_BATTERY_CHARGER_EVENT_LOG")
+        cg.add_define("BATTERY_CHARGER_EVENT_LOG_SIZE", event_log[CONF_EVENT_LOG_SIZE])
+        cg.add(var.set_event_log_restore(event_log[CONF_RESTORE_FROM_FLASH]))
+        cg.add(var.set_event_log_save_interval(event_log[CONF_SAVE_INTERVAL]))
+        # every charger keeps its own ring in flash
+        cg.add(var.set_preference_hash(preference_hash(config[CONF_ID].id)))
+
+    if control := config.get(CONF_OUTPUT_CONTROL):
+        out = await cg.get_variable(control[CONF_OUTPUT])
+        cg.add(var.set_output(out))
+        cg.add(var.set_control_interval(control[CONF_CONTROL_INTERVAL]))
+        cg.add(var.set_voltage_gains(control[CONF_VOLTAGE_KP], control[CONF_VOLTAGE_KI]))
+        cg.add(var.set_current_gains(control[CONF_CURRENT_KP], control[CONF_CURRENT_KI]))
+        cg.add(var.set_output_slew_rate(control[CONF_SLEW_RATE]))
+        cg.add(var.set_output_range(control[CONF_MIN_POWER], control[CONF_MAX_POWER]))
+        if CONF_CURRENT_LIMIT in control:
+            cg.add(var.set_current_limit(control[CONF_CURRENT_LIMIT]))
+
+
+DumpEventsAction = charger_ns.class_("DumpEventsAction", automation.Action)
+
+
+@automation.register_action(
+    "battery_charger.dump_events",
+    DumpEventsAction,
+    automation.maybe_simple_id(
+        {
+            cv.GenerateID(): cv.use_id(ChargerComponent),
+        }
+    ),
+)
+async def dump_events_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
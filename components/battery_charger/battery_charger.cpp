@@ -5,22 +5,39 @@ namespace esphome {
 namespace battery_charger {
 
 static const char *const TAG = "BatteryCharger";
+// charging resumes only this far inside the temperature cut-offs
+static const float TEMPERATURE_HYSTERESIS = 2.0f;
 
 float ChargerComponent::get_setup_priority() const { return setup_priority::DATA; }
 
+static const char *charge_state_to_str(uint8_t state) {
+  switch (state) {
+    case INITIAL: return "INITIAL";
+    case BEFORE_ABSORPTION: return "BEFORE_ABSORPTION";
+    case ABSORPTION: return "ABSORPTION";
+    case BEFORE_FLOAT: return "BEFORE_FLOAT";
+    case FLOAT: return "FLOAT";
+    case BEFORE_EQUALIZATION: return "BEFORE_equalization";
+    case EQUALIZATION: return "equalization";
+    case ERROR: return "ERROR";
+    case BEFORE_ERROR: return "BEFORE_ERROR";
+    default: return "INVALID_STATE";
+  }
+}
+
 
 void ChargerComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "ChargerComponent:");
 
   // Output voltage settings
-  ESP_LOGCONFIG(TAG, "  Float Voltage: %0.2f V", this->float_voltage_.value_or(-1));
-  ESP_LOGCONFIG(TAG, "  Absorption Voltage: %0.2f V", this->absorption_voltage_v_.value_or(-1));
-  ESP_LOGCONFIG(TAG, "  equalization Voltage: %0.2f V", this->equalization_voltage_v_.value_or(-1));
-  ESP_LOGCONFIG(TAG, "  Absorption Restart Voltage: %0.2f V", this->absorption_restart_voltage_v_.value_or(-1));
+  ESP_LOGCONFIG(TAG, "  Float Voltage: %0.2f V", this->profile_.float_voltage);
+  ESP_LOGCONFIG(TAG, "  Absorption Voltage: %0.2f V", this->profile_.absorption_voltage);
+  ESP_LOGCONFIG(TAG, "  equalization Voltage: %0.2f V", this->profile_.equalization_voltage);
+  ESP_LOGCONFIG(TAG, "  Absorption Restart Voltage: %0.2f V", this->profile_.absorption_restart_voltage);
   
   // Output current and voltage readings
   ESP_LOGCONFIG(TAG, "  Current Voltage: %0.2f V", this->last_voltage_);
-  ESP_LOGCONFIG(TAG, "  Current Current: %0.2f A", this->last_current_.value());
+  ESP_LOGCONFIG(TAG, "  Current Current: %0.2f A", this->last_current_.value_or(NAN));
 
   // Output timer and delay settings
   ESP_LOGCONFIG(TAG, "  Absorption Timer: %d seconds", this->absorption_timer_.time_s);
@@ -31,20 +48,7 @@ void ChargerComponent::dump_config() {
   ESP_LOGCONFIG(TAG, "  Absorption Low Voltage Delay: %d seconds", this->absorption_low_voltage_timer_.time_s);
 
   // Output current charge state
-  const char* charge_state_str = "UNKNOWN";
-  switch (this->charge_state_) {
-      case INITIAL: charge_state_str = "INITIAL"; break;
-      case BEFORE_ABSORPTION: charge_state_str = "BEFORE_ABSORPTION"; break;
-      case ABSORPTION: charge_state_str = "ABSORPTION"; break;
-      case BEFORE_FLOAT: charge_state_str = "BEFORE_FLOAT"; break;
-      case FLOAT: charge_state_str = "FLOAT"; break;
-      case BEFORE_EQUALIZATION: charge_state_str = "BEFORE_equalization"; break;
-      case EQUALIZATION: charge_state_str = "equalization"; break;
-      case ERROR: charge_state_str = "ERROR"; break;
-      case BEFORE_ERROR: charge_state_str = "BEFORE_ERROR"; break;
-      default: charge_state_str = "INVALID_STATE"; break;
-  }
-  ESP_LOGCONFIG(TAG, "  Current Charge State: %s", charge_state_str);
+  ESP_LOGCONFIG(TAG, "  Current Charge State: %s", charge_state_to_str(this->charge_state_));
 
   // Output additional settings if available
   if (this->voltage_target_sensor_ != nullptr) {
@@ -72,12 +76,62 @@ void ChargerComponent::dump_config() {
   }
 
   // Output additional settings for absorption current threshold
-  ESP_LOGCONFIG(TAG, "  Absorption Current Threshold: %0.2f A", this->absorption_current_a_.value_or(-1));
-  ESP_LOGCONFIG(TAG, "  Max Voltage: %0.2f V", this->max_voltage_.value());
-  ESP_LOGCONFIG(TAG, "  Min Voltage: %0.2f V", this->min_voltage_.value_or(-1));
+  ESP_LOGCONFIG(TAG, "  Absorption Current Threshold: %0.2f A", this->profile_.absorption_current);
+  ESP_LOGCONFIG(TAG, "  Max Voltage: %0.2f V", this->profile_.max_voltage);
+  ESP_LOGCONFIG(TAG, "  Min Voltage: %0.2f V", this->profile_.min_voltage);
+
+  if (this->temperature_sensor_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Temperature Compensation: %0.1f mV/°C/cell x %d cells (reference %0.1f °C)",
+                  this->base_profile_.temperature_compensation_mv, this->base_profile_.cells, this->base_profile_.temperature_reference);
+    ESP_LOGCONFIG(TAG, "  Charge Temperature Range: [%0.1f, %0.1f] °C",
+                  this->base_profile_.min_charge_temperature, this->base_profile_.max_charge_temperature);
+  }
+
+  #ifdef USE_BATTERY_CHARGER_COULOMB_METER
+  if (this->coulomb_meter_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Absorption Charge Factor: %0.0f %%", this->absorption_charge_factor_ * 100);
+  }
+  #endif
+
+  #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+  ESP_LOGCONFIG(TAG, "  Event Log: %d of %d events, boot %d%s", this->event_log_.count, BATTERY_CHARGER_EVENT_LOG_SIZE,
+                this->event_log_.boots, this->event_log_restore_ ? ", restored from flash" : "");
+  #endif
+
+  #ifdef USE_OUTPUT
+  if (this->output_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Output Control: every %d ms", this->control_interval_ms_);
+    ESP_LOGCONFIG(TAG, "  Output Current Limit: %0.2f A", this->current_limit_a_.value_or(-1));
+  }
+  #endif
 }
 
 
+void ChargerComponent::set_profile(const ChargeProfile &profile) {
+  this->base_profile_ = profile;
+  this->profile_ = profile;
+
+  this->absorption_timer_.setup(this, profile.absorption_time_s, "ABSORPTION_TIMER");
+  this->absorption_restart_timer_.setup(this, profile.absorption_restart_time_s, "ABSORPTION_TIMER_RESTART");
+  this->absorption_low_voltage_timer_.setup(this, profile.absorption_low_voltage_delay_s, "ABSORPTION_LOW_VOLTAGE");
+
+  this->equalization_timer_.setup(this, profile.equalization_time_s, "equalization_TIME");
+  this->equalization_interval_timer_.setup(this, profile.equalization_interval_s, "equalization_INTERVAL_TIMER");
+  this->equalization_timeout_timer_.setup(this, profile.equalization_timeout_s, "equalization_TIMEOUT");
+
+  this->voltage_auto_recovery_delay_timer_.setup(this, profile.voltage_auto_recovery_delay_s, "AUTO_RECOVERY");
+
+  #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+  this->watch_timer_(this->absorption_timer_, TIMER_ABSORPTION);
+  this->watch_timer_(this->absorption_restart_timer_, TIMER_ABSORPTION_RESTART);
+  this->watch_timer_(this->absorption_low_voltage_timer_, TIMER_ABSORPTION_LOW_VOLTAGE);
+  this->watch_timer_(this->equalization_timer_, TIMER_EQUALIZATION);
+  this->watch_timer_(this->equalization_interval_timer_, TIMER_EQUALIZATION_INTERVAL);
+  this->watch_timer_(this->equalization_timeout_timer_, TIMER_EQUALIZATION_TIMEOUT);
+  this->watch_timer_(this->voltage_auto_recovery_delay_timer_, TIMER_AUTO_RECOVERY);
+  #endif
+}
+
 void ChargerComponent::setup() {
     ESP_LOGCONFIG(TAG, "Setting up ChargerComponent...");
 
@@ -87,17 +141,39 @@ void ChargerComponent::setup() {
       return;
     }
 
-    if (!this->float_voltage_.has_value()) {
+    if (std::isnan(this->profile_.float_voltage)) {
       ESP_LOGE(TAG, "Missing required float voltage");
       this->mark_failed();
       return;
     }
+
+    #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+    this->event_log_.clear();
+    if (this->event_log_restore_) {
+      this->flash_event_log_ = global_preferences->make_preference<ChargerEventLog>(
+          fnv1_hash("battery_charger_event_log") ^ this->preference_hash_, true);
+      if (!this->flash_event_log_.load(&this->event_log_) || !this->event_log_.is_valid()) {
+        ESP_LOGD(TAG, "No stored event log, starting a new one");
+        this->event_log_.clear();
+      }
+      // a reset or power loss only loses the events since the last save
+      this->set_interval("EVENT_LOG_SAVE", this->event_log_save_interval_ms_, [this]() {
+        if (this->event_log_changed_) {
+          this->save_event_log_();
+        }
+      });
+    }
+    this->event_log_.boots++;
+    this->log_event_(EVENT_BOOT, this->event_log_.boots);
+    #endif
+
     this->set_timeout("NO_VOLTAGE_UPDATE_FOR_LONG_TIME", 5 * 60 * 1000, [this]() {
       this->status_set_error("No voltage updates, is sensor working?");
+      this->log_event_(EVENT_NO_VOLTAGE);
       this->charge_state_ = BEFORE_ERROR;
       this->updateState();
     });
-    this->last_voltage_ = this->float_voltage_.value_or(0);
+    this->last_voltage_ = this->profile_.float_voltage;
     this->updateState();
     this->voltage_sensor_->add_on_state_callback([this](float voltage){
       ESP_LOGV(TAG, "Volatge: %.2f V", voltage);
@@ -106,8 +182,11 @@ void ChargerComponent::setup() {
         return;
       }
       this->last_voltage_ = voltage;
+      this->voltage_measured_ = true;
+      this->voltage_fresh_ = true;
       this->set_timeout("NO_VOLTAGE_UPDATE_FOR_LONG_TIME", 5 * 60 * 1000, [this]() {
         this->status_set_error("No voltage update for long time, is sensor working?");
+        this->log_event_(EVENT_NO_VOLTAGE);
         this->charge_state_ = BEFORE_ERROR;
         this->updateState();
       });
@@ -123,34 +202,67 @@ void ChargerComponent::setup() {
           return;
         }
         this->last_current_ = current;
+        this->current_fresh_ = true;
+        this->updateState();
+      });
+    }
+
+    if (this->temperature_sensor_ != nullptr) {
+      this->temperature_sensor_->add_on_state_callback([this](float temperature) {
+        // voltage samples reuse the compensated profile, it only changes with the temperature
+        if (std::isnan(temperature) || temperature == this->last_temperature_) {
+          return;
+        }
+        ESP_LOGV(TAG, "Temperature: %.1f °C", temperature);
+        this->last_temperature_ = temperature;
+        this->update_compensation_();
         this->updateState();
       });
     }
 
+    #ifdef USE_OUTPUT
+    if (this->output_ != nullptr) {
+      this->last_control_us_ = micros();
+      this->set_interval("OUTPUT_CONTROL", this->control_interval_ms_, [this]() { this->control_output_(); });
+    }
+    #endif
+
     this->status_clear_warning();
 }
 
 void ChargerComponent::updateState() {
 
   if (this->charge_state_ != ERROR && this->charge_state_ != BEFORE_ERROR) {
-    if (this->max_voltage_.has_value() && this->last_voltage_  > this->max_voltage_.value_or(-1)) {
-      ESP_LOGE(TAG, "ERROR: Voltage '%.2fV' is over max voltage '%.2fV'", this->last_voltage_ , this->max_voltage_.value_or(-1));
+    // unset limits are NAN and never trigger
+    if (this->last_voltage_ > this->profile_.max_voltage) {
+      ESP_LOGE(TAG, "ERROR: Voltage '%.2fV' is over max voltage '%.2fV'", this->last_voltage_ , this->profile_.max_voltage);
+      this->log_event_(EVENT_OVER_VOLTAGE);
+      this->charge_state_ = BEFORE_ERROR;
+    } else if (this->last_voltage_ < this->profile_.min_voltage) {
+      ESP_LOGE(TAG, "ERROR: Voltage '%.2fV' is under min voltage '%.2fV'", this->last_voltage_ , this->profile_.min_voltage);
+      this->log_event_(EVENT_UNDER_VOLTAGE);
       this->charge_state_ = BEFORE_ERROR;
-    } else if (this->min_voltage_.has_value()  && this->last_voltage_  < this->min_voltage_.value_or(-1)) {
-      ESP_LOGE(TAG, "ERROR: Voltage '%.2fV' is under min voltage '%.2fV'", this->last_voltage_ , this->min_voltage_.value_or(-1));
+    } else if (this->last_temperature_ < this->profile_.min_charge_temperature || this->last_temperature_ > this->profile_.max_charge_temperature) {
+      ESP_LOGE(TAG, "ERROR: Temperature '%.1f°C' is outside of charge range [%.1f, %.1f]", this->last_temperature_, this->profile_.min_charge_temperature, this->profile_.max_charge_temperature);
+      this->log_event_(EVENT_TEMPERATURE, (int16_t) lroundf(this->last_temperature_ * 10));
+      this->temperature_fault_ = true;
       this->charge_state_ = BEFORE_ERROR;
     }
   }
 
+  #ifdef USE_BATTERY_CHARGER_COULOMB_METER
+  this->track_deficit_();
+  #endif
+
   switch(this->charge_state_) {
     case INITIAL:
       ESP_LOGD(TAG, "Charge status INITIAL");
-      if (this->absorption_voltage_v_.has_value()) {
+      if (this->profile_.has_absorption()) {
         this->call_update_state_later(BEFORE_ABSORPTION);
       } else {
         this->call_update_state_later(BEFORE_FLOAT);
       }
-      if (this->equalization_voltage_v_.has_value()) {
+      if (this->profile_.has_equalization()) {
         this->equalization_interval_timer_.start([this]() {
           this->call_update_state_later(BEFORE_EQUALIZATION);
         });
@@ -158,9 +270,7 @@ void ChargerComponent::updateState() {
     break;
     case BEFORE_ABSORPTION:
       ESP_LOGD(TAG, "Charge status becoming ABSORPTION");
-      if (this->voltage_target_sensor_ != nullptr) {
-        this->voltage_target_sensor_->publish_state(this->absorption_voltage_v_.value_or(0));
-      }
+      this->set_target_voltage_(this->profile_.absorption_voltage);
       #ifdef USE_TEXT_SENSOR
       if (this->charge_state_sensor_ != nullptr) {
         this->charge_state_sensor_->publish_state("ABSORPTION");
@@ -174,10 +284,16 @@ void ChargerComponent::updateState() {
     break;
     case ABSORPTION:
       ESP_LOGV(TAG, "Charge status ABSORPTION");
-      if (this->last_voltage_ >= this->absorption_voltage_v_.value_or(-1)) {
-        ESP_LOGV(TAG, "Voltage has been reached absorption level: %.02f of %.02f", this->last_voltage_, this->absorption_voltage_v_.value_or(-1));
-        if (this->absorption_current_a_.has_value() && this->last_current_.has_value() && this->last_current_.value() > this->absorption_current_a_.value()) {
-          ESP_LOGV(TAG, "Cancel absorption timer: due to current is above required level: %.2f of %.2f", this->last_current_.value(), this->absorption_current_a_.value());
+      if (this->last_voltage_ >= this->profile_.absorption_voltage) {
+        ESP_LOGV(TAG, "Voltage has been reached absorption level: %.02f of %.02f", this->last_voltage_, this->profile_.absorption_voltage);
+        #ifdef USE_BATTERY_CHARGER_COULOMB_METER
+        if (this->is_charge_returned_()) {
+          this->call_update_state_later(BEFORE_FLOAT);
+          return;
+        }
+        #endif
+        if (this->last_current_.has_value() && this->last_current_.value() > this->profile_.absorption_current) {
+          ESP_LOGV(TAG, "Cancel absorption timer: due to current is above required level: %.2f of %.2f", this->last_current_.value(), this->profile_.absorption_current);
           this->absorption_timer_.stop();
           return;
         }
@@ -188,22 +304,23 @@ void ChargerComponent::updateState() {
           this->call_update_state_later(BEFORE_FLOAT);
         });
       } else {
-        ESP_LOGV(TAG, "Voltage don't reach absorption level: %.02f of %.02f", this->last_voltage_, this->absorption_voltage_v_.value_or(-1));
+        ESP_LOGV(TAG, "Voltage don't reach absorption level: %.02f of %.02f", this->last_voltage_, this->profile_.absorption_voltage);
         this->absorption_timer_.stop();
       }
 
     break;
     case BEFORE_FLOAT:
       ESP_LOGD(TAG, "Charge status becoming FLOAT");
-      if (this->voltage_target_sensor_ != nullptr) {
-        this->voltage_target_sensor_->publish_state(this->float_voltage_.value_or(-1));
-      }
+      #ifdef USE_BATTERY_CHARGER_COULOMB_METER
+      this->mark_full_charge_();
+      #endif
+      this->set_target_voltage_(this->profile_.float_voltage);
       #ifdef USE_TEXT_SENSOR
       if (this->charge_state_sensor_ != nullptr) {
         this->charge_state_sensor_->publish_state("FLOAT");
       }
       #endif
-      if (this->absorption_voltage_v_.has_value()) {
+      if (this->profile_.has_absorption()) {
         ESP_LOGV(TAG, "Setting up absorption_restart_timer for %i", this->absorption_restart_timer_.time_s);
         this->absorption_restart_timer_.start([this]() {
           this->call_update_state_later(BEFORE_ABSORPTION);
@@ -219,8 +336,8 @@ void ChargerComponent::updateState() {
     break;
     case FLOAT:
       ESP_LOGV(TAG, "Charge status FLOAT");
-      if (this->absorption_voltage_v_.has_value() && this->absorption_restart_voltage_v_.has_value()) {
-        if (this->last_voltage_ < absorption_restart_voltage_v_.value_or(-1)) {
+      if (this->profile_.has_absorption() && this->profile_.has_absorption_restart()) {
+        if (this->last_voltage_ < this->profile_.absorption_restart_voltage) {
           this->absorption_low_voltage_timer_.start([this]() {
             this->call_update_state_later(BEFORE_ABSORPTION);
           });
@@ -236,9 +353,7 @@ void ChargerComponent::updateState() {
       this->absorption_timer_.stop();
       this->absorption_low_voltage_timer_.stop();
 
-      if (this->voltage_target_sensor_ != nullptr) {
-        this->voltage_target_sensor_->publish_state(this->equalization_voltage_v_.value_or(0));
-      }
+      this->set_target_voltage_(this->profile_.equalization_voltage);
       #ifdef USE_TEXT_SENSOR
       if (this->charge_state_sensor_ != nullptr) {
         this->charge_state_sensor_->publish_state("equalization");
@@ -258,8 +373,8 @@ void ChargerComponent::updateState() {
     break;
     case EQUALIZATION:
       ESP_LOGV(TAG, "Charge status equalization");
-      if (this->last_voltage_ >= this->equalization_voltage_v_.value_or(0)) {
-        ESP_LOGV(TAG, "Voltage level reaches equalization level: %.2f of %.2f", this->last_voltage_, this->equalization_voltage_v_.value_or(0));
+      if (this->last_voltage_ >= this->profile_.equalization_voltage) {
+        ESP_LOGV(TAG, "Voltage level reaches equalization level: %.2f of %.2f", this->last_voltage_, this->profile_.equalization_voltage);
 
         this->equalization_timer_.start([this]() {
           ESP_LOGV(TAG, "equalization is complete. Switching to FLOAT (setup equalization_interval)");
@@ -270,7 +385,7 @@ void ChargerComponent::updateState() {
           this->call_update_state_later(BEFORE_FLOAT);
         });
       } else {
-        ESP_LOGV(TAG, "Voltage level is below equalization: %.2f of %.2f", this->last_voltage_, this->equalization_voltage_v_.value_or(0));
+        ESP_LOGV(TAG, "Voltage level is below equalization: %.2f of %.2f", this->last_voltage_, this->profile_.equalization_voltage);
 
         this->equalization_timer_.stop();
       }
@@ -285,9 +400,7 @@ void ChargerComponent::updateState() {
       this->equalization_interval_timer_.stop();
       this->equalization_timeout_timer_.stop();
 
-      if (this->voltage_target_sensor_ != nullptr) {
-        this->voltage_target_sensor_->publish_state(0);
-      }
+      this->set_target_voltage_(0);
       #ifdef USE_TEXT_SENSOR
       if (this->charge_state_sensor_ != nullptr) {
         this->charge_state_sensor_->publish_state("ERROR");
@@ -300,18 +413,28 @@ void ChargerComponent::updateState() {
     break;
     case ERROR:
       ESP_LOGV(TAG, "Charge status ERROR");
-      if (this->voltage_auto_recovery_delay_timer_.time_s != 0 && (this->min_voltage_.has_value() || this->max_voltage_.has_value())) {
-        auto is_min_ok = this->min_voltage_.has_value() ? this->last_voltage_ >= this->min_voltage_ : true;
-        auto is_max_ok = this->max_voltage_.has_value() ? this->last_voltage_ <= this->max_voltage_ : true;
+      if (this->temperature_fault_) {
+        const bool is_min_ok = !(this->last_temperature_ < this->profile_.min_charge_temperature + TEMPERATURE_HYSTERESIS);
+        const bool is_max_ok = !(this->last_temperature_ > this->profile_.max_charge_temperature - TEMPERATURE_HYSTERESIS);
+        if (is_min_ok && is_max_ok) {
+          ESP_LOGD(TAG, "Temperature is back in charge range: %.1f °C", this->last_temperature_);
+          this->temperature_fault_ = false;
+          this->status_clear_error();
+          this->call_update_state_later(INITIAL);
+        }
+      } else if (this->voltage_auto_recovery_delay_timer_.time_s != 0 && this->profile_.has_voltage_limits()) {
+        // written as negated comparisons so an unset (NAN) limit is always ok
+        const bool is_min_ok = !(this->last_voltage_ < this->profile_.min_voltage);
+        const bool is_max_ok = !(this->last_voltage_ > this->profile_.max_voltage);
 
         if (is_min_ok && is_max_ok) {
-          ESP_LOGV(TAG, "Voltage level reaches recovery conditions: %.2f of [%.2f, %.2f]", this->last_voltage_, this->min_voltage_.value_or(-1), this->max_voltage_.value_or(-1));
+          ESP_LOGV(TAG, "Voltage level reaches recovery conditions: %.2f of [%.2f, %.2f]", this->last_voltage_, this->profile_.min_voltage, this->profile_.max_voltage);
           this->voltage_auto_recovery_delay_timer_.start([this]() {
             this->status_clear_error();
             this->call_update_state_later(INITIAL);
           });
         } else {
-          ESP_LOGV(TAG, "Voltage level DONT reaches recovery conditions: %.2f of [%.2f, %.2f]", this->last_voltage_, this->min_voltage_.value_or(-1), this->max_voltage_.value_or(-1));
+          ESP_LOGV(TAG, "Voltage level DONT reaches recovery conditions: %.2f of [%.2f, %.2f]", this->last_voltage_, this->profile_.min_voltage, this->profile_.max_voltage);
           this->voltage_auto_recovery_delay_timer_.stop();
         }
       }
@@ -325,12 +448,233 @@ void ChargerComponent::updateState() {
   }
 }
 
+void ChargerComponent::set_target_voltage_(float voltage) {
+  this->target_voltage_ = voltage;
+  if (this->voltage_target_sensor_ != nullptr) {
+    this->voltage_target_sensor_->publish_state(voltage);
+  }
+}
+
+void ChargerComponent::update_compensation_() {
+  this->profile_ = ChargeProfile::compensated(this->base_profile_, this->last_temperature_);
+  ESP_LOGV(TAG, "Compensated for %.1f °C: float %.2f V, absorption %.2f V, equalization %.2f V", this->last_temperature_,
+           this->profile_.float_voltage, this->profile_.absorption_voltage, this->profile_.equalization_voltage);
+
+  // follow the new setpoint right away, BEFORE_* states publish it themselves
+  switch (this->charge_state_) {
+    case ABSORPTION:
+      this->set_target_voltage_(this->profile_.absorption_voltage);
+      break;
+    case FLOAT:
+      this->set_target_voltage_(this->profile_.float_voltage);
+      break;
+    case EQUALIZATION:
+      this->set_target_voltage_(this->profile_.equalization_voltage);
+      break;
+    default:
+      break;
+  }
+}
+
+#ifdef USE_BATTERY_CHARGER_COULOMB_METER
+void ChargerComponent::mark_full_charge_() {
+  if (this->coulomb_meter_ == nullptr) {
+    return;
+  }
+  this->full_charge_in_c_ = this->coulomb_meter_->get_cumulative_charge_in_c();
+  this->full_charge_out_c_ = this->coulomb_meter_->get_cumulative_charge_out_c();
+  this->max_deficit_c_ = 0;
+  this->full_charge_marked_ = true;
+}
+
+int64_t ChargerComponent::net_discharge_c_() {
+  const auto charge_in = this->coulomb_meter_->get_cumulative_charge_in_c() - this->full_charge_in_c_;
+  const auto charge_out = this->coulomb_meter_->get_cumulative_charge_out_c() - this->full_charge_out_c_;
+  return (int64_t) charge_out - (int64_t) charge_in;
+}
+
+void ChargerComponent::track_deficit_() {
+  if (this->coulomb_meter_ == nullptr || !this->full_charge_marked_) {
+    return;
+  }
+  const auto net = this->net_discharge_c_();
+  if (net > this->max_deficit_c_) {
+    this->max_deficit_c_ = net;
+  }
+}
+
+bool ChargerComponent::is_charge_returned_() {
+  // nothing to compare with until the first full charge, then timer/current decide
+  if (this->coulomb_meter_ == nullptr || !this->full_charge_marked_) {
+    return false;
+  }
+  this->track_deficit_();
+  if (this->max_deficit_c_ <= 0) {
+    // periodic refresh of a battery that was not discharged
+    return false;
+  }
+  const auto put_back = this->max_deficit_c_ - this->net_discharge_c_();
+  const float returned = (float) put_back / this->max_deficit_c_;
+  ESP_LOGV(TAG, "Charge returned: %.1f%% of %.1f%%", returned * 100, this->absorption_charge_factor_ * 100);
+  if (returned < this->absorption_charge_factor_) {
+    return false;
+  }
+  ESP_LOGD(TAG, "Returned %.1f%% of discharged %.3f Ah, ending absorption", returned * 100,
+           this->max_deficit_c_ / 3600.0f);
+  return true;
+}
+#endif
+
+#ifdef USE_OUTPUT
+void ChargerComponent::control_output_() {
+  const auto now = micros();
+  const float dt_s = (now - this->last_control_us_) / 1000000.0f;
+  this->last_control_us_ = now;
+
+  if (std::isnan(this->target_voltage_) || this->target_voltage_ <= 0 || !this->voltage_measured_) {
+    // not charging, or no real voltage yet: hold the output at its lower bound
+    // and restart the ramp from there
+    this->voltage_pi_.reset(this->output_min_level_);
+    this->current_pi_.reset(this->output_min_level_);
+    this->output_slew_.reset(this->output_min_level_);
+    this->voltage_demand_ = this->output_min_level_;
+    this->current_demand_ = this->output_min_level_;
+    this->voltage_fresh_ = false;
+    this->current_fresh_ = false;
+    this->output_->set_level(this->output_min_level_);
+    return;
+  }
+
+  // A loop only steps on a sample that arrived since the last tick, otherwise
+  // its demand is held; without any new sample the output is held as it is.
+  const bool voltage_fresh = this->voltage_fresh_;
+  const bool limit_current = this->current_limit_a_.has_value() && this->last_current_.has_value();
+  const bool current_fresh = limit_current && this->current_fresh_;
+  this->voltage_fresh_ = false;
+  this->current_fresh_ = false;
+  if (!voltage_fresh && !current_fresh) {
+    return;
+  }
+
+  // CV loop and CC loop run side by side, the lower demand wins
+  const float voltage_error = this->target_voltage_ - this->last_voltage_;
+  if (voltage_fresh) {
+    this->voltage_demand_ = this->voltage_pi_.update(voltage_error, dt_s);
+  }
+  float level = this->voltage_demand_;
+
+  float current_error = 0;
+  if (limit_current) {
+    current_error = this->current_limit_a_.value() - this->last_current_.value();
+    if (current_fresh) {
+      this->current_demand_ = this->current_pi_.update(current_error, dt_s);
+    }
+    level = std::min(level, this->current_demand_);
+  }
+
+  level = this->output_slew_.update(level, dt_s);
+
+  if (voltage_fresh) {
+    this->voltage_pi_.track(level, voltage_error);
+  }
+  if (current_fresh) {
+    this->current_pi_.track(level, current_error);
+  }
+
+  this->output_->set_level(level);
+}
+#endif
+
 void ChargerComponent::call_update_state_later(CHARGE_STATES new_state) {
   this->set_timeout("UPDATE_STATUS", 16, [this, new_state]() {
+    const auto previous_state = this->charge_state_;
     this->charge_state_ = new_state;
+    switch (new_state) {
+      // BEFORE_* states only set up the next one, they are not logged
+      case INITIAL:
+      case ABSORPTION:
+      case FLOAT:
+      case EQUALIZATION:
+      case ERROR:
+        if (new_state != previous_state) {
+          this->log_event_(EVENT_STATE, previous_state);
+        }
+        break;
+      default:
+        break;
+    }
+    #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+    if (new_state == ERROR && previous_state != ERROR) {
+      this->save_event_log_();
+    }
+    #endif
     this->updateState();
   });
 }
+
+void ChargerComponent::log_event_(ChargerEventType type, int16_t arg) {
+  #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+  this->event_log_.record({
+    millis(),
+    type,
+    (uint8_t) this->charge_state_,
+    arg,
+    this->last_voltage_,
+    this->last_current_.value_or(NAN),
+  });
+  this->event_log_changed_ = true;
+  #endif
+}
+
+#ifdef USE_BATTERY_CHARGER_EVENT_LOG
+static const char *event_type_to_str(uint8_t type) {
+  switch (type) {
+    case EVENT_BOOT: return "BOOT";
+    case EVENT_STATE: return "STATE";
+    case EVENT_TIMER_START: return "TIMER_START";
+    case EVENT_TIMER_STOP: return "TIMER_STOP";
+    case EVENT_TIMER_FIRE: return "TIMER_FIRE";
+    case EVENT_OVER_VOLTAGE: return "OVER_VOLTAGE";
+    case EVENT_UNDER_VOLTAGE: return "UNDER_VOLTAGE";
+    case EVENT_TEMPERATURE: return "TEMPERATURE";
+    case EVENT_NO_VOLTAGE: return "NO_VOLTAGE";
+    default: return "UNKNOWN";
+  }
+}
+
+void ChargerComponent::watch_timer_(InternalTimer &timer, ChargerTimerId id) {
+  timer.set_listener([this, id](ChargerEventType type) { this->log_event_(type, id); });
+}
+
+void ChargerComponent::save_event_log_() {
+  if (!this->event_log_restore_) {
+    return;
+  }
+  if (!this->flash_event_log_.save(&this->event_log_)) {
+    ESP_LOGW(TAG, "Failed to store event log");
+    return;
+  }
+  this->event_log_changed_ = false;
+}
+
+void ChargerComponent::on_shutdown() {
+  this->save_event_log_();
+}
+
+#endif
+
+void ChargerComponent::dump_events() {
+  #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+  ESP_LOGI(TAG, "Event log, %d events (oldest first):", this->event_log_.count);
+  for (uint16_t i = 0; i < this->event_log_.count; i++) {
+    const ChargerEvent event = this->event_log_.at(i);
+    ESP_LOGI(TAG, "  %10u ms %-13s %-19s arg=%-5d %6.2f V %6.2f A", event.timestamp_ms, event_type_to_str(event.type),
+             charge_state_to_str(event.state), event.arg, event.voltage, event.current);
+  }
+  #else
+  ESP_LOGW(TAG, "Event log is not enabled, add 'event_log:' to battery_charger");
+  #endif
+}
   
 
 } // 
@@ -2,11 +2,21 @@
 
 #include "esphome/core/component.h"
 #include "esphome/core/application.h"
+#include "esphome/core/automation.h"
 
 #include "esphome/components/sensor/sensor.h"
 #ifdef USE_TEXT_SENSOR
 #include "esphome/components/text_sensor/text_sensor.h"
 #endif
+#ifdef USE_OUTPUT
+#include "esphome/components/output/float_output.h"
+#endif
+#ifdef USE_BATTERY_CHARGER_COULOMB_METER
+#include "../coulomb_meter/coulomb_meter.h"
+#endif
+#include "charge_profile.h"
+#include "event_log.h"
+#include "pi_controller.h"
 
 namespace esphome {
 namespace battery_charger {
@@ -30,9 +40,11 @@ namespace battery_charger {
         App.scheduler.set_timeout(this->component_, this->name_, this->time_s * 1000, [this, func](){
           ESP_LOGV("BatteryCharger", "Fired timer '%s' after %i sec", this->name_, this->time_s);
           this->is_running_ = false;
+          this->notify_(EVENT_TIMER_FIRE);
           func();
         });
         this->is_running_ = true;
+        this->notify_(EVENT_TIMER_START);
       }
     }
 
@@ -41,14 +53,30 @@ namespace battery_charger {
         ESP_LOGV("BatteryCharger", "Stoping timer '%s'", this->name_);
         this->is_running_ = false;
         App.scheduler.cancel_timeout(this->component_, this->name_);
+        this->notify_(EVENT_TIMER_STOP);
       }
     }
 
+    #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+    void set_listener(std::function<void(ChargerEventType)> &&listener) { this->listener_ = std::move(listener); }
+    #endif
+
     u_int32_t time_s{0};
     protected:
+      void notify_(ChargerEventType type) {
+        #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+        if (this->listener_) {
+          this->listener_(type);
+        }
+        #endif
+      }
+
       Component* component_;
       const char *name_;
       bool is_running_{false};
+      #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+      std::function<void(ChargerEventType)> listener_;
+      #endif
   };
 
   enum CHARGE_STATES {
@@ -69,67 +97,145 @@ class ChargerComponent : public Component {
   float get_setup_priority() const override;
   // void loop() override;
 
-  void set_float_voltage(float float_voltage) { float_voltage_ = float_voltage; };
+  void set_profile(const ChargeProfile &profile);
 
   void set_voltage_sensor(sensor::Sensor *sensor) { voltage_sensor_ = sensor; };
   void set_current_sensor(sensor::Sensor *sensor) { current_sensor_ = sensor; };
+  void set_temperature_sensor(sensor::Sensor *sensor) { temperature_sensor_ = sensor; };
   #ifdef USE_TEXT_SENSOR
   void set_charge_state_sensor(text_sensor::TextSensor *sensor) { charge_state_sensor_ = sensor; };
   #endif
   void set_voltage_target_sensor(sensor::Sensor *sensor) { voltage_target_sensor_ = sensor; };
+  #ifdef USE_BATTERY_CHARGER_COULOMB_METER
+  void set_coulomb_meter(coulomb_meter::CoulombMeter *meter) { coulomb_meter_ = meter; };
+  void set_absorption_charge_factor(float factor) { absorption_charge_factor_ = factor; };
+  #endif
 
+  // logs the event ring, oldest first
+  void dump_events();
+  #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+  void on_shutdown() override;
+  void set_event_log_restore(bool restore) { event_log_restore_ = restore; };
+  void set_event_log_save_interval(u_int32_t interval_ms) { event_log_save_interval_ms_ = interval_ms; };
+  // seeds the flash key of the ring, so several chargers on one node keep their own
+  void set_preference_hash(uint32_t hash) { preference_hash_ = hash; };
+  // for lambdas that export the raw 16 byte records, see ChargerEventLog::at()
+  const ChargerEventLog &get_event_log() const { return this->event_log_; };
+  #endif
 
-  void set_absorption_time(u_int32_t time) { this->absorption_timer_.setup(this, time, "ABSORPTION_TIMER"); };
-  void set_absorption_voltage(float voltage) { absorption_voltage_v_ = voltage; };
-  void set_absorption_restart_voltage(float voltage) { absorption_restart_voltage_v_ = voltage; };
-  void set_absorption_current(float current) { absorption_current_a_ = current; };
-  void set_absorption_restart_time(u_int32_t time) { this->absorption_restart_timer_.setup(this, time, "ABSORPTION_TIMER_RESTART"); };
-  void set_absorption_low_voltage_delay_s_(u_int32_t time) { this->absorption_low_voltage_timer_.setup(this, time, "ABSORPTION_LOW_VOLTAGE"); };
-
-
-  void set_equalization_time(u_int32_t time) { this->equalization_timer_.setup(this, time, "equalization_TIME"); };
-  void set_equalization_interval(u_int32_t time) { this->equalization_interval_timer_.setup(this, time, "equalization_INTERVAL_TIMER"); };
-  void set_equalization_timeout(u_int32_t time) { this->equalization_timeout_timer_.setup(this, time, "equalization_TIMEOUT"); };
-  void set_equalization_voltage(float voltage) { equalization_voltage_v_ = voltage; };
-
-  void set_max_voltage(float voltage) { max_voltage_ = voltage; };
-  void set_min_voltage(float voltage) { min_voltage_ = voltage; };
-  void set_voltage_auto_recovery_delay(u_int32_t time) { this->voltage_auto_recovery_delay_timer_.setup(this, time, "AUTO_RECOVERY");};
+  #ifdef USE_OUTPUT
+  void set_output(output::FloatOutput *output) { output_ = output; };
+  #endif
+  void set_control_interval(u_int32_t interval_ms) { control_interval_ms_ = interval_ms; };
+  void set_voltage_gains(float kp, float ki) { this->voltage_pi_.set_gains(kp, ki); };
+  void set_current_gains(float kp, float ki) { this->current_pi_.set_gains(kp, ki); };
+  void set_current_limit(float current) { current_limit_a_ = current; };
+  void set_output_slew_rate(float rate) { this->output_slew_.set_rate(rate); };
+  void set_output_range(float min_level, float max_level) {
+    this->output_min_level_ = min_level;
+    this->voltage_pi_.set_output_range(min_level, max_level);
+    this->current_pi_.set_output_range(min_level, max_level);
+  };
 
  protected:
     void updateState();
     void call_update_state_later(CHARGE_STATES new_state);
+    void set_target_voltage_(float voltage);
+    void update_compensation_();
+    void log_event_(ChargerEventType type, int16_t arg = 0);
+    #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+    void watch_timer_(InternalTimer &timer, ChargerTimerId id);
+    void save_event_log_();
+    #endif
+    #ifdef USE_BATTERY_CHARGER_COULOMB_METER
+    void mark_full_charge_();
+    // charge out minus charge in since the full charge, in C
+    int64_t net_discharge_c_();
+    void track_deficit_();
+    bool is_charge_returned_();
+    #endif
+    #ifdef USE_OUTPUT
+    void control_output_();
+    #endif
     CHARGE_STATES charge_state_{INITIAL};
 
-    optional<float> absorption_voltage_v_;
-    optional<float> absorption_current_a_;
+    // as configured
+    ChargeProfile base_profile_{NAN, NAN, NAN, NAN, 0, 0, 0, NAN, 0, 0, 0, NAN, NAN, 0, 1, 0, 25, NAN, NAN};
+    // base_profile_ compensated for last_temperature_, used by the state machine
+    ChargeProfile profile_{base_profile_};
+
     InternalTimer absorption_restart_timer_;
-    
-    optional<float> absorption_restart_voltage_v_;
     InternalTimer absorption_timer_;
     InternalTimer absorption_low_voltage_timer_;
 
-    optional<float> equalization_voltage_v_;
     InternalTimer equalization_timeout_timer_;
     InternalTimer equalization_interval_timer_;
     InternalTimer equalization_timer_;
     
     sensor::Sensor *voltage_sensor_{nullptr};
     sensor::Sensor *current_sensor_{nullptr};
+    sensor::Sensor *temperature_sensor_{nullptr};
     sensor::Sensor *voltage_target_sensor_{nullptr};
     #ifdef USE_TEXT_SENSOR
     text_sensor::TextSensor *charge_state_sensor_{nullptr};
     #endif
-    optional<float> float_voltage_;
-
     optional<float> last_current_;
     float last_voltage_{0};
+    // a real voltage sample arrived, last_voltage_ is no longer the float voltage seed
+    bool voltage_measured_{false};
+    // samples the output control has not stepped on yet
+    bool voltage_fresh_{false};
+    bool current_fresh_{false};
+    float last_temperature_{NAN};
+    bool temperature_fault_{false};
 
-    optional<float> max_voltage_;
-    optional<float> min_voltage_;
-  
     InternalTimer voltage_auto_recovery_delay_timer_;
+
+    #ifdef USE_BATTERY_CHARGER_COULOMB_METER
+    coulomb_meter::CoulombMeter *coulomb_meter_{nullptr};
+    float absorption_charge_factor_{1.02f};
+    // meter counters when the battery was last full. The deficit is the
+    // deepest net discharge since then, absorption ends once the charge put
+    // back since that low point covers the deficit times the factor. Float
+    // charge on a full battery does not count towards it.
+    bool full_charge_marked_{false};
+    uint64_t full_charge_in_c_{0};
+    uint64_t full_charge_out_c_{0};
+    int64_t max_deficit_c_{0};
+    #endif
+
+    // stage setpoint, 0 means charging is stopped
+    float target_voltage_{NAN};
+
+    #ifdef USE_BATTERY_CHARGER_EVENT_LOG
+    ChargerEventLog event_log_{};
+    bool event_log_restore_{false};
+    // events recorded since the ring was last saved
+    bool event_log_changed_{false};
+    u_int32_t event_log_save_interval_ms_{15 * 60 * 1000};
+    uint32_t preference_hash_{0};
+    ESPPreferenceObject flash_event_log_{nullptr};
+    #endif
+
+    #ifdef USE_OUTPUT
+    output::FloatOutput *output_{nullptr};
+    #endif
+    u_int32_t control_interval_ms_{10};
+    u_int32_t last_control_us_{0};
+    optional<float> current_limit_a_;
+    float output_min_level_{0};
+    // the loops' latest demands, held while their sensor has no new sample
+    float voltage_demand_{0};
+    float current_demand_{0};
+    PIController voltage_pi_;
+    PIController current_pi_;
+    SlewRateLimiter output_slew_;
 };
 
+  template<typename... Ts> class DumpEventsAction : public Action<Ts...>, public Parented<ChargerComponent> {
+   public:
+    void play(Ts... x) override { this->parent_->dump_events(); }
+  };
+
 }  // namespace baterry_charger
 }  // namespace esphome
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace battery_charger {
+
+  // Charge parameters of one battery bank. Instances are generated at codegen
+  // time as `static constexpr` tables (built-in chemistry profile merged with
+  // the per-field overrides from yaml). Voltages/currents that are not used
+  // are NAN, which never compares true, so threshold checks need no extra
+  // "is configured" lookup.
+  struct ChargeProfile {
+    float float_voltage;
+    float absorption_voltage;
+    float absorption_restart_voltage;
+    float absorption_current;
+    uint32_t absorption_time_s;
+    uint32_t absorption_restart_time_s;
+    uint32_t absorption_low_voltage_delay_s;
+
+    float equalization_voltage;
+    uint32_t equalization_time_s;
+    uint32_t equalization_interval_s;
+    uint32_t equalization_timeout_s;
+
+    float max_voltage;
+    float min_voltage;
+    uint32_t voltage_auto_recovery_delay_s;
+
+    uint8_t cells;
+    // mV per degree Celsius per cell, applied relative to temperature_reference
+    float temperature_compensation_mv;
+    float temperature_reference;
+    float min_charge_temperature;
+    float max_charge_temperature;
+
+    bool has_absorption() const { return !std::isnan(this->absorption_voltage); }
+    bool has_absorption_restart() const { return !std::isnan(this->absorption_restart_voltage); }
+    bool has_absorption_current() const { return !std::isnan(this->absorption_current); }
+    bool has_equalization() const { return !std::isnan(this->equalization_voltage); }
+    bool has_voltage_limits() const { return !std::isnan(this->max_voltage) || !std::isnan(this->min_voltage); }
+
+    // compensated copy of `base`: charge setpoints move by the configured mV/°C/cell,
+    // safety limits stay put and setpoints never exceed max_voltage
+    static ChargeProfile compensated(const ChargeProfile &base, float temperature) {
+      ChargeProfile profile = base;
+      if (std::isnan(temperature) || base.temperature_compensation_mv == 0) {
+        return profile;
+      }
+      const float offset_v = base.temperature_compensation_mv * base.cells * (temperature - base.temperature_reference) / 1000.0f;
+      // unlike fmin() this keeps a NAN (disabled) setpoint disabled
+      auto shift = [&](float voltage) {
+        voltage += offset_v;
+        return voltage > base.max_voltage ? base.max_voltage : voltage;
+      };
+      profile.float_voltage = shift(base.float_voltage);
+      profile.absorption_voltage = shift(base.absorption_voltage);
+      profile.absorption_restart_voltage = shift(base.absorption_restart_voltage);
+      profile.equalization_voltage = shift(base.equalization_voltage);
+      return profile;
+    }
+  };
+
+}  // namespace battery_charger
+}  // namespace esphome
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <cstdint>
+
+#ifndef BATTERY_CHARGER_EVENT_LOG_SIZE
+#define BATTERY_CHARGER_EVENT_LOG_SIZE 32
+#endif
+
+namespace esphome {
+namespace battery_charger {
+
+  enum ChargerEventType : uint8_t {
+    EVENT_BOOT,           // arg: boot number since the log was created
+    EVENT_STATE,          // arg: previous state
+    EVENT_TIMER_START,    // arg: ChargerTimerId
+    EVENT_TIMER_STOP,     // arg: ChargerTimerId
+    EVENT_TIMER_FIRE,     // arg: ChargerTimerId
+    EVENT_OVER_VOLTAGE,
+    EVENT_UNDER_VOLTAGE,
+    EVENT_TEMPERATURE,    // arg: temperature in 0.1 °C
+    EVENT_NO_VOLTAGE,
+  };
+
+  enum ChargerTimerId : uint8_t {
+    TIMER_ABSORPTION,
+    TIMER_ABSORPTION_RESTART,
+    TIMER_ABSORPTION_LOW_VOLTAGE,
+    TIMER_EQUALIZATION,
+    TIMER_EQUALIZATION_INTERVAL,
+    TIMER_EQUALIZATION_TIMEOUT,
+    TIMER_AUTO_RECOVERY,
+  };
+
+  struct __attribute__((packed)) ChargerEvent {
+    uint32_t timestamp_ms;  // millis() of the boot the event belongs to
+    uint8_t type;           // ChargerEventType
+    uint8_t state;          // CHARGE_STATES after the event
+    int16_t arg;
+    float voltage;
+    float current;          // NAN without current sensor
+  };
+  static_assert(sizeof(ChargerEvent) == 16, "ChargerEvent is stored and exported as 16 bytes");
+
+  // Ring of the latest events. Plain data, so the whole ring is saved to and
+  // loaded from flash as a single preference; on ESP8266 that has to fit in
+  // the 512 byte preference area, the schema limits the size there.
+  struct ChargerEventLog {
+    ChargerEvent events[BATTERY_CHARGER_EVENT_LOG_SIZE];
+    uint16_t next;
+    uint16_t count;
+    uint16_t boots;
+
+    void clear() {
+      this->next = 0;
+      this->count = 0;
+      this->boots = 0;
+    }
+
+    bool is_valid() const {
+      return this->next < BATTERY_CHARGER_EVENT_LOG_SIZE && this->count <= BATTERY_CHARGER_EVENT_LOG_SIZE;
+    }
+
+    void record(const ChargerEvent &event) {
+      this->events[this->next] = event;
+      if (++this->next == BATTERY_CHARGER_EVENT_LOG_SIZE) {
+        this->next = 0;
+      }
+      if (this->count < BATTERY_CHARGER_EVENT_LOG_SIZE) {
+        this->count++;
+      }
+    }
+
+    // index 0 is the oldest event
+    const ChargerEvent &at(uint16_t index) const {
+      uint16_t pos = this->next + index + BATTERY_CHARGER_EVENT_LOG_SIZE - this->count;
+      if (pos >= BATTERY_CHARGER_EVENT_LOG_SIZE) {
+        pos -= BATTERY_CHARGER_EVENT_LOG_SIZE;
+      }
+      return this->events[pos];
+    }
+  };
+
+}  // namespace battery_charger
+}  // namespace esphome
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace battery_charger {
+
+  // Proportional-integral regulator with back-calculation anti-windup.
+  // The integral term is re-derived from the output that was really applied
+  // (after min-select, clamping and slew limiting), so a loop that is not in
+  // control or is saturated never winds up and takes over bumplessly.
+  class PIController {
+    public:
+    void set_gains(float kp, float ki) {
+      this->kp_ = kp;
+      this->ki_ = ki;
+    }
+
+    void set_output_range(float out_min, float out_max) {
+      this->out_min_ = out_min;
+      this->out_max_ = out_max;
+    }
+
+    float update(float error, float dt_s) {
+      const float out = this->kp_ * error + this->integral_ + this->ki_ * error * dt_s;
+      return clamp(out, this->out_min_, this->out_max_);
+    }
+
+    void track(float applied, float error) {
+      this->integral_ = clamp(applied - this->kp_ * error, this->out_min_, this->out_max_);
+    }
+
+    void reset(float output) { this->integral_ = clamp(output, this->out_min_, this->out_max_); }
+
+    protected:
+      float kp_{0};
+      float ki_{0};
+      float out_min_{0};
+      float out_max_{1};
+      float integral_{0};
+  };
+
+  // Limits how fast the output may move, in output units per second.
+  class SlewRateLimiter {
+    public:
+    void set_rate(float rate_per_s) { this->rate_per_s_ = rate_per_s; }
+
+    float update(float target, float dt_s) {
+      if (this->rate_per_s_ > 0) {
+        const float max_step = this->rate_per_s_ * dt_s;
+        target = clamp(target, this->value_ - max_step, this->value_ + max_step);
+      }
+      this->value_ = target;
+      return target;
+    }
+
+    void reset(float value) { this->value_ = value; }
+    float value() const { return this->value_; }
+
+    protected:
+      float rate_per_s_{0};
+      float value_{0};
+  };
+
+}  // namespace battery_charger
+}  // namespace esphome
@@ -1,8 +1,19 @@
 import esphome.codegen as cg
 import esphome.config_validation as cv
-from esphome.components import sensor
+from esphome import automation
+from esphome.components import sensor, uart
+from esphome.core import CORE, EsphomeError
 from esphome.const import (
+    CONF_ID,
+    DEVICE_CLASS_CURRENT,
+    DEVICE_CLASS_DURATION,
+    DEVICE_CLASS_POWER,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_AMPERE,
     UNIT_PERCENT,
+    UNIT_SECOND,
+    UNIT_WATT,
     ICON_TIMER,
     UNIT_MINUTE,
     UNIT_WATT_HOURS,
@@ -38,6 +49,43 @@ CONF_ENERGY_CALCULATED_SENSOR = "energy_calculated_sensor"
 CONF_CHARGE_TIME_REMAINING_SENSOR = "charge_time_remaining_sensor"
 CONF_DISCHARGE_TIME_REMAINING_SENSOR = "discharge_time_remaining_sensor"
 
+CONF_STATS = "stats"
+CONF_PERCENTILE = "percentile"
+
+UNIT_MICROSECOND = "µs"
+
+coulomb_meter_ns = cg.esphome_ns.namespace("coulomb_meter")
+CoulombMeter_ns = coulomb_meter_ns.class_(
+    "CoulombMeter", cg.PollingComponent
+)
+CoulombMeterStats = coulomb_meter_ns.class_("CoulombMeterStats", cg.PollingComponent)
+DumpStatsAction = coulomb_meter_ns.class_("DumpStatsAction", automation.Action)
+
+MeterHistogram = coulomb_meter_ns.enum("MeterHistogram")
+# stats key -> histogram, each one can publish its percentile as a sensor
+HISTOGRAMS = {
+    "i2c_latency": MeterHistogram.HISTOGRAM_I2C_LATENCY,
+    "calc_charge_time": MeterHistogram.HISTOGRAM_CALC_CHARGE,
+    "sample_interval": MeterHistogram.HISTOGRAM_SAMPLE_INTERVAL,
+    "update_state_time": MeterHistogram.HISTOGRAM_UPDATE_STATE,
+    "report_sensors_time": MeterHistogram.HISTOGRAM_REPORT_SENSORS,
+}
+
+_LATENCY_SENSOR = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MICROSECOND,
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+STATS_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(CoulombMeterStats),
+        cv.Optional(CONF_PERCENTILE, default=99): cv.float_range(min=0, max=100),
+        **{cv.Optional(key): _LATENCY_SENSOR for key in HISTOGRAMS},
+    }
+).extend(cv.polling_component_schema("60s"))
+
 
 COULOMB_SCHEMA = cv.Schema({
     cv.Required(CONF_FULLCHARGE_VOLTAGE): cv.All(cv.voltage, cv.Range(min=0.0)),
@@ -111,15 +159,32 @@ COULOMB_SCHEMA = cv.Schema({
         unit_of_measurement=UNIT_WATT_HOURS,
         accuracy_decimals=3
     ),
+    # latency histograms of the hot path, logged by coulomb_meter.dump_stats
+    cv.Optional(CONF_STATS): STATS_SCHEMA,
 })
-coulomb_meter_ns = cg.esphome_ns.namespace("coulomb_meter")
-CoulombMeter_ns = coulomb_meter_ns.class_(
-    "CoulombMeter", cg.PollingComponent
-)
+
+def preference_hash(value):
+    # FNV-1, like fnv1_hash() on the device
+    hash_ = 2166136261
+    for char in value.encode():
+        hash_ = ((hash_ * 16777619) & 0xFFFFFFFF) ^ char
+    return hash_
+
 
 async def setup_coulomb(var, config):
     # await cg.register_component(var, config)
 
+    # every meter keeps its charge, counters and learned capacity under keys of its own
+    meter_id = config[CONF_ID].id
+    hash_ = preference_hash(meter_id)
+    used = CORE.data.setdefault("coulomb_meter_preference_hashes", {})
+    if hash_ in used:
+        raise EsphomeError(
+            f"Coulomb meters '{used[hash_]}' and '{meter_id}' would share their saved state, rename one of them"
+        )
+    used[hash_] = meter_id
+    cg.add(var.set_preference_hash(hash_))
+
     cg.add(var.set_fully_charge_voltage(config[CONF_FULLCHARGE_VOLTAGE]))
     cg.add(var.set_fully_charge_current(config[CONF_FULLCHARGE_CURRENT]))
     cg.add(var.set_fully_charge_time(config[CONF_FULLCHARGE_TIME]))
@@ -177,6 +242,273 @@ async def setup_coulomb(var, config):
         sens = await sensor.new_sensor(conf)
         cg.add(var.set_energy_calculated_sensor(sens))
 
+    if conf := config.get(CONF_STATS):
+        await stats_to_code(var, conf)
+
+
+async def stats_to_code(meter, config):
+    cg.add_define("USE_COULOMB_METER_STATS")
+    stats = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(stats, config)
+    cg.add(stats.set_meter(meter))
+    cg.add(stats.set_percentile(config[CONF_PERCENTILE] / 100))
+    for key, histogram in HISTOGRAMS.items():
+        if conf := config.get(key):
+            sens = await sensor.new_sensor(conf)
+            cg.add(stats.set_sensor(histogram, sens))
+
+
+
+SampleStat = coulomb_meter_ns.enum("SampleStat")
+SAMPLE_STATS = {
+    "min": SampleStat.SAMPLE_STAT_MIN,
+    "max": SampleStat.SAMPLE_STAT_MAX,
+    "mean": SampleStat.SAMPLE_STAT_MEAN,
+    "rms": SampleStat.SAMPLE_STAT_RMS,
+    # peak to peak
+    "ripple": SampleStat.SAMPLE_STAT_RIPPLE,
+}
+
+CONF_CURRENT_STATISTICS = "current_statistics"
+CONF_POWER_STATISTICS = "power_statistics"
+
+
+def _sample_stats_schema(unit, device_class, accuracy_decimals):
+    return cv.Schema(
+        {
+            cv.Optional(key): sensor.sensor_schema(
+                unit_of_measurement=unit,
+                accuracy_decimals=accuracy_decimals,
+                device_class=device_class,
+                state_class=STATE_CLASS_MEASUREMENT,
+            )
+            for key in SAMPLE_STATS
+        }
+    )
+
+
+# statistics over every sample of an update interval, for INA platforms
+SAMPLE_STATS_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_CURRENT_STATISTICS): _sample_stats_schema(UNIT_AMPERE, DEVICE_CLASS_CURRENT, 3),
+        cv.Optional(CONF_POWER_STATISTICS): _sample_stats_schema(UNIT_WATT, DEVICE_CLASS_POWER, 2),
+    }
+)
+
+
+async def setup_sample_stats(var, config):
+    for key, setter in (
+        (CONF_CURRENT_STATISTICS, var.set_current_stat_sensor),
+        (CONF_POWER_STATISTICS, var.set_power_stat_sensor),
+    ):
+        for stat, value in SAMPLE_STATS.items():
+            if conf := config.get(key, {}).get(stat):
+                sens = await sensor.new_sensor(conf)
+                cg.add(setter(value, sens))
+
+
+
+CONF_GAP_FACTOR = "gap_factor"
+CONF_GAP_COUNT = "gap_count"
+CONF_GAP_DURATION = "gap_duration"
+
+# loop stalls: intervals above gap_factor x the nominal sample period are
+# integrated with the trapezoid between the samples around them
+GAP_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_GAP_FACTOR, default=5): cv.float_range(min=1.5, max=1000),
+        cv.Optional(CONF_GAP_COUNT): sensor.sensor_schema(
+            accuracy_decimals=0,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+        cv.Optional(CONF_GAP_DURATION): sensor.sensor_schema(
+            unit_of_measurement=UNIT_SECOND,
+            accuracy_decimals=3,
+            device_class=DEVICE_CLASS_DURATION,
+            state_class=STATE_CLASS_TOTAL_INCREASING,
+            entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+        ),
+    }
+)
+
+
+async def setup_gap_detection(var, config):
+    cg.add(var.set_gap_factor(config[CONF_GAP_FACTOR]))
+    if conf := config.get(CONF_GAP_COUNT):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_gap_count_sensor(sens))
+    if conf := config.get(CONF_GAP_DURATION):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_gap_duration_sensor(sens))
+
+CONF_CAPTURE = "capture"
+CONF_SAMPLES = "samples"
+CONF_PRE_TRIGGER = "pre_trigger"
+CONF_CURRENT_ABOVE = "current_above"
+CONF_CURRENT_BELOW = "current_below"
+CONF_MAX_SLOPE = "max_slope"
+CONF_ON_CAPTURE = "on_capture"
+
+WaveformCapture = coulomb_meter_ns.class_("WaveformCapture")
+CaptureTriggerAction = coulomb_meter_ns.class_("CaptureTriggerAction", automation.Action)
+CaptureRearmAction = coulomb_meter_ns.class_("CaptureRearmAction", automation.Action)
+CaptureDumpAction = coulomb_meter_ns.class_("CaptureDumpAction", automation.Action)
+
+
+def validate_capture(config):
+    if config[CONF_PRE_TRIGGER] >= config[CONF_SAMPLES]:
+        raise cv.Invalid(f"{CONF_PRE_TRIGGER} has to be less than {CONF_SAMPLES}")
+    return config
+
+
+# pre/post-trigger ring of raw samples, 8 bytes per sample
+CAPTURE_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(WaveformCapture),
+            cv.Optional(CONF_SAMPLES, default=512): cv.int_range(min=16, max=8192),
+            cv.Optional(CONF_PRE_TRIGGER, default=128): cv.int_range(min=0),
+            cv.Optional(CONF_CURRENT_ABOVE): cv.current,
+            cv.Optional(CONF_CURRENT_BELOW): cv.current,
+            # A/s between two samples
+            cv.Optional(CONF_MAX_SLOPE): cv.positive_float,
+            cv.Optional(CONF_ON_CAPTURE): automation.validate_automation({}),
+        }
+    ),
+    validate_capture,
+)
+
+CAPTURE_PLATFORM_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_CAPTURE): CAPTURE_SCHEMA,
+    }
+)
+
+
+async def setup_capture(var, config):
+    if not (conf := config.get(CONF_CAPTURE)):
+        return
+    cg.add_define("USE_COULOMB_METER_CAPTURE")
+    capture = cg.new_Pvariable(conf[CONF_ID])
+    cg.add(capture.set_size(conf[CONF_SAMPLES]))
+    cg.add(capture.set_pre_trigger(conf[CONF_PRE_TRIGGER]))
+    if CONF_CURRENT_ABOVE in conf:
+        cg.add(capture.set_current_above(conf[CONF_CURRENT_ABOVE]))
+    if CONF_CURRENT_BELOW in conf:
+        cg.add(capture.set_current_below(conf[CONF_CURRENT_BELOW]))
+    if CONF_MAX_SLOPE in conf:
+        cg.add(capture.set_max_slope(conf[CONF_MAX_SLOPE]))
+    for automation_conf in conf.get(CONF_ON_CAPTURE, []):
+        await automation.build_automation(capture.get_capture_trigger(), [], automation_conf)
+    cg.add(var.set_capture(capture))
+
+
+CAPTURE_ACTION_SCHEMA = automation.maybe_simple_id(
+    {
+        cv.GenerateID(): cv.use_id(WaveformCapture),
+    }
+)
+
+
+@automation.register_action("coulomb_meter.capture_trigger", CaptureTriggerAction, CAPTURE_ACTION_SCHEMA)
+@automation.register_action("coulomb_meter.capture_rearm", CaptureRearmAction, CAPTURE_ACTION_SCHEMA)
+@automation.register_action("coulomb_meter.capture_dump", CaptureDumpAction, CAPTURE_ACTION_SCHEMA)
+async def capture_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+
+CONF_STREAM = "stream"
+CONF_RECORDS_PER_FRAME = "records_per_frame"
+CONF_BUFFER_SIZE = "buffer_size"
+CONF_DROPPED_RECORDS = "dropped_records"
+
+SampleStream = coulomb_meter_ns.class_("SampleStream", cg.PollingComponent, uart.UARTDevice)
+StreamStartAction = coulomb_meter_ns.class_("StreamStartAction", automation.Action)
+StreamStopAction = coulomb_meter_ns.class_("StreamStopAction", automation.Action)
+
+
+def validate_buffer_size(value):
+    value = cv.int_range(min=256, max=32768)(value)
+    # the free running ring indices wrap at 2^32, a multiple of the size
+    if value & (value - 1) != 0:
+        raise cv.Invalid(f"{CONF_BUFFER_SIZE} has to be a power of two")
+    return value
+
+# every raw sample as framed, delta-encoded records on a UART, decoded on the
+# host by tools/ina_stream_decode.py
+STREAM_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(SampleStream),
+            cv.Optional(CONF_RECORDS_PER_FRAME, default=16): cv.int_range(min=1, max=20),
+            cv.Optional(CONF_BUFFER_SIZE, default=4096): validate_buffer_size,
+            cv.Optional(CONF_DROPPED_RECORDS): sensor.sensor_schema(
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_TOTAL_INCREASING,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+            ),
+        }
+    )
+    .extend(uart.UART_DEVICE_SCHEMA)
+    .extend(cv.polling_component_schema("60s"))
+)
+
+STREAM_PLATFORM_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_STREAM): STREAM_SCHEMA,
+    }
+)
+
+
+async def setup_stream(var, config):
+    if not (conf := config.get(CONF_STREAM)):
+        return
+    cg.add_define("USE_COULOMB_METER_STREAM")
+    stream = cg.new_Pvariable(conf[CONF_ID])
+    await cg.register_component(stream, conf)
+    await uart.register_uart_device(stream, conf)
+    cg.add(stream.set_records_per_frame(conf[CONF_RECORDS_PER_FRAME]))
+    cg.add(stream.set_buffer_size(conf[CONF_BUFFER_SIZE]))
+    if sens_conf := conf.get(CONF_DROPPED_RECORDS):
+        sens = await sensor.new_sensor(sens_conf)
+        cg.add(stream.set_dropped_records_sensor(sens))
+    cg.add(var.set_stream(stream))
+
+
+STREAM_ACTION_SCHEMA = automation.maybe_simple_id(
+    {
+        cv.GenerateID(): cv.use_id(SampleStream),
+    }
+)
+
+
+@automation.register_action("coulomb_meter.stream_start", StreamStartAction, STREAM_ACTION_SCHEMA)
+@automation.register_action("coulomb_meter.stream_stop", StreamStopAction, STREAM_ACTION_SCHEMA)
+async def stream_action_to_code(config, action_id, template_arg, args):
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
+
+@automation.register_action(
+    "coulomb_meter.dump_stats",
+    DumpStatsAction,
+    automation.maybe_simple_id(
+        {
+            cv.GenerateID(): cv.use_id(CoulombMeter_ns),
+        }
+    ),
+)
+async def dump_stats_to_code(config, action_id, template_arg, args):
+    # the histograms are only recorded with this define, stats: is optional for the dump
+    cg.add_define("USE_COULOMB_METER_STATS")
+    var = cg.new_Pvariable(action_id, template_arg)
+    await cg.register_parented(var, config[CONF_ID])
+    return var
+
 CONFIG_SCHEMA = cv.Schema({})
     
 
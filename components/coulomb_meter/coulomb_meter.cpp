@@ -1,4 +1,5 @@
 #include "coulomb_meter.h"
+#include <cinttypes>
 
 // .platformio/packages/toolchain-xtensa-esp32/bin/xtensa-esp32-elf-addr2line -pfiaC -e esphome_config/.esphome/build/ina226coulomb/.pioenvs/ina226coulomb/firmware.elf  0x4023bf0b
 namespace esphome {
@@ -37,21 +38,21 @@ namespace esphome {
         });
       }
 
-      rtc_current_charge_c_ = global_preferences->make_preference<int32_t>(fnv1_hash("current_charge_c"), false);
-      rtc_current_energy_j_ = global_preferences->make_preference<int32_t>(fnv1_hash("current_energy_j"), false);
+      rtc_current_charge_c_ = global_preferences->make_preference<int32_t>(this->preference_key_("current_charge_c"), false);
+      rtc_current_energy_j_ = global_preferences->make_preference<int32_t>(this->preference_key_("current_energy_j"), false);
 
-      rtc_cumulative_at_full_in_c_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_at_full_in_c_"), false);
-      rtc_cumulative_at_full_in_j_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_at_full_in_j_"), false);
-      rtc_cumulative_at_full_out_c_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_at_full_out_c_"), false);
-      rtc_cumulative_at_full_out_j_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_at_full_out_j_"), false);
+      rtc_cumulative_at_full_in_c_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_at_full_in_c_"), false);
+      rtc_cumulative_at_full_in_j_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_at_full_in_j_"), false);
+      rtc_cumulative_at_full_out_c_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_at_full_out_c_"), false);
+      rtc_cumulative_at_full_out_j_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_at_full_out_j_"), false);
       
-      rtc_cumulative_charge_in_c_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_charge_in_c_"), false);
-      rtc_cumulative_energy_in_j_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_energy_in_j_"), false);
-      rtc_cumulative_charge_out_c_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_charge_out_c_"), false);
-      rtc_cumulative_energy_out_j_ = global_preferences->make_preference<uint64_t>(fnv1_hash("cumulative_energy_out_j_"), false);
+      rtc_cumulative_charge_in_c_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_charge_in_c_"), false);
+      rtc_cumulative_energy_in_j_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_energy_in_j_"), false);
+      rtc_cumulative_charge_out_c_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_charge_out_c_"), false);
+      rtc_cumulative_energy_out_j_ = global_preferences->make_preference<uint64_t>(this->preference_key_("cumulative_energy_out_j_"), false);
 
-      flash_full_charge_calculated_c_ = global_preferences->make_preference<int32_t>(fnv1_hash("CoulombMeter_full_charge_calculated_c"), true);
-      flash_full_energy_calculated_j_ = global_preferences->make_preference<int32_t>(fnv1_hash("CoulombMeter_full_energy_calculated_j"), true);
+      flash_full_charge_calculated_c_ = global_preferences->make_preference<int32_t>(this->preference_key_("CoulombMeter_full_charge_calculated_c"), true);
+      flash_full_energy_calculated_j_ = global_preferences->make_preference<int32_t>(this->preference_key_("CoulombMeter_full_energy_calculated_j"), true);
 
       uint64_t tmp_cumulative_charge_in_c_ = 0;
       if (rtc_cumulative_charge_in_c_.load(&tmp_cumulative_charge_in_c_)) {
@@ -136,6 +137,9 @@ namespace esphome {
     }
 
     void CoulombMeter::updateState() {
+      #ifdef USE_COULOMB_METER_STATS
+      const ScopedLatency timing(this->histograms_[HISTOGRAM_UPDATE_STATE]);
+      #endif
       const auto voltage = this->get_voltage();
       const auto charge = this->get_charge_c();
 
@@ -297,7 +301,10 @@ namespace esphome {
     }
 
     void CoulombMeter::reportSensors() {
-      
+      #ifdef USE_COULOMB_METER_STATS
+      const ScopedLatency timing(this->histograms_[HISTOGRAM_REPORT_SENSORS]);
+      #endif
+
       switch (report_count_ % SENSORS_COUNT) {
         case 0:
           if (charge_level_sensor_ != nullptr) {
@@ -427,6 +434,44 @@ namespace esphome {
 
       ESP_LOGCONFIG(TAG, "Coulomb Meter Config: ...");
     }
+    #ifdef USE_COULOMB_METER_STATS
+    static const char *histogram_to_str(uint8_t histogram) {
+      switch (histogram) {
+        case HISTOGRAM_I2C_LATENCY: return "I2C latency";
+        case HISTOGRAM_CALC_CHARGE: return "calc_charge()";
+        case HISTOGRAM_SAMPLE_INTERVAL: return "Sample interval";
+        case HISTOGRAM_UPDATE_STATE: return "updateState()";
+        case HISTOGRAM_REPORT_SENSORS: return "reportSensors()";
+        default: return "UNKNOWN";
+      }
+    }
+
+    void CoulombMeter::dump_stats() {
+      ESP_LOGI(TAG, "Latency histograms, µs:");
+      for (uint8_t i = 0; i < HISTOGRAM_COUNT; i++) {
+        LatencyHistogram &histogram = this->histograms_[i];
+        if (histogram.count == 0) {
+          ESP_LOGI(TAG, "  %s: no samples", histogram_to_str(i));
+          continue;
+        }
+        ESP_LOGI(TAG, "  %s: %" PRIu32 " samples, mean %.1f, max %" PRIu32, histogram_to_str(i), histogram.count,
+                 (float) histogram.total_us / histogram.count, histogram.max_us);
+        for (uint8_t bucket = 0; bucket < LatencyHistogram::BUCKETS; bucket++) {
+          if (histogram.counts[bucket] == 0) {
+            continue;
+          }
+          if (bucket == LatencyHistogram::BUCKETS - 1) {
+            ESP_LOGI(TAG, "    >= %" PRIu32 ": %" PRIu32, LatencyHistogram::bucket_end_us(bucket - 1), histogram.counts[bucket]);
+          } else {
+            ESP_LOGI(TAG, "    < %" PRIu32 ": %" PRIu32, LatencyHistogram::bucket_end_us(bucket), histogram.counts[bucket]);
+          }
+        }
+        histogram.clear();
+      }
+      this->histogram_resets_++;
+    }
+    #endif
+
     float CoulombMeter::get_setup_priority() const { return setup_priority::DATA; }
 
     float CoulombMeter::get_voltage() { 
@@ -3,6 +3,10 @@
 #include "esphome/core/component.h"
 #include "esphome/core/application.h"
 #include <optional>  
+#ifdef USE_COULOMB_METER_STATS
+#include "esphome/core/automation.h"
+#include "latency_histogram.h"
+#endif
 
 namespace esphome {
 namespace coulomb_meter {
@@ -49,6 +53,7 @@ class InternalTimer {
     bool is_running_{false};
 };
 
+// Average of the last `size` values, the running sum keeps get() O(1).
 class MovingAverage {
   public:
 
@@ -57,37 +62,48 @@ class MovingAverage {
       this->values_.assign(size, 0);
       this->count_ = 0;
       this->index_ = 0;
+      this->sum_ = 0;
     }
 
     void add(const int32_t value) {
+      if (this->count_ == this->size_) {
+        this->sum_ -= this->values_[this->index_];
+      } else {
+        this->count_++;
+      }
       this->values_[this->index_] = value;
+      this->sum_ += value;
       this->index_ = (this->index_ + 1) % this->size_;
-
-      if (count_ < size_) {
-        count_++;
-      }
     }
 
-    float get() {
+    float get() const {
       if (count_ == 0) {
         return 0.0f;
       }
-      
-      int64_t sum = 0;
-      for (int i = 0; i < this->count_; i++) {
-        sum += this->values_[i];
-      }
-      
-      return (float)sum / count_;
+      return (float)this->sum_ / count_;
     }
 
   private:
     int size_{0};
     int index_{0};
     int count_{0};
+    int64_t sum_{0};
     std::vector<int32_t> values_;
 };
 
+#ifdef USE_COULOMB_METER_STATS
+enum MeterHistogram : uint8_t {
+  // every register read of calc_charge()
+  HISTOGRAM_I2C_LATENCY,
+  HISTOGRAM_CALC_CHARGE,
+  // time between two integrated samples, loop jitter shows up here
+  HISTOGRAM_SAMPLE_INTERVAL,
+  HISTOGRAM_UPDATE_STATE,
+  HISTOGRAM_REPORT_SENSORS,
+  HISTOGRAM_COUNT,
+};
+#endif
+
 class CoulombMeter : public PollingComponent {
  public:
   // CoulombMeter() : PollingComponent(0), energy_usage_average_(6) {};
@@ -106,6 +122,8 @@ class CoulombMeter : public PollingComponent {
 
   void set_full_capacity(float capacity) { full_capacity_c_ = capacity * 3600; };
   void set_full_energy(float energy) { full_energy_j_ = energy * 3600; };
+  // seeds the preference keys, so several meters on one node keep separate state
+  void set_preference_hash(uint32_t hash) { preference_hash_ = hash; };
 
   void set_charge_level_sensor(sensor::Sensor *sensor) { charge_level_sensor_ = sensor; };
   void set_charge_out_sensor(sensor::Sensor *sensor) { charge_out_sensor_ = sensor; };
@@ -127,6 +145,18 @@ class CoulombMeter : public PollingComponent {
   virtual int64_t get_charge_c();
   virtual int64_t get_energy_j();
 
+  // lifetime counters of charge that went into / out of the battery, updated once per second
+  uint64_t get_cumulative_charge_in_c() const { return this->cumulative_charge_in_c_; };
+  uint64_t get_cumulative_charge_out_c() const { return this->cumulative_charge_out_c_; };
+
+  #ifdef USE_COULOMB_METER_STATS
+  const LatencyHistogram &get_histogram(MeterHistogram histogram) const { return this->histograms_[histogram]; };
+  // counts dump_stats() calls, windows that span one have to start over
+  uint32_t get_histogram_resets() const { return this->histogram_resets_; };
+  // logs all histograms and starts them over
+  void dump_stats();
+  #endif
+
  protected:
     void reportSensors();
     void updateState();
@@ -146,6 +176,8 @@ class CoulombMeter : public PollingComponent {
     int32_t full_capacity_c_{0};
     int32_t full_energy_j_{0};
     optional<int32_t> full_charge_calculated_c_;
+    uint32_t preference_hash_{0};
+    uint32_t preference_key_(const char *name) const { return fnv1_hash(name) ^ this->preference_hash_; }
     ESPPreferenceObject flash_full_charge_calculated_c_{nullptr};
     optional<int32_t> full_energy_calculated_j_;
     ESPPreferenceObject flash_full_energy_calculated_j_{nullptr};
@@ -189,7 +221,31 @@ class CoulombMeter : public PollingComponent {
     int32_t prev_time_energy_j_{0};
 
     uint8_t report_count_{0};
+
+    #ifdef USE_COULOMB_METER_STATS
+    // for the drivers' calc_charge(), once per integrated sample
+    void record_sample_() {
+      const uint32_t now = micros();
+      if (this->has_sample_) {
+        this->histograms_[HISTOGRAM_SAMPLE_INTERVAL].add(now - this->last_sample_us_);
+      }
+      this->last_sample_us_ = now;
+      this->has_sample_ = true;
+    }
+
+    LatencyHistogram histograms_[HISTOGRAM_COUNT]{};
+    uint32_t histogram_resets_{0};
+    uint32_t last_sample_us_{0};
+    bool has_sample_{false};
+    #endif
+};
+
+#ifdef USE_COULOMB_METER_STATS
+template<typename... Ts> class DumpStatsAction : public Action<Ts...>, public Parented<CoulombMeter> {
+ public:
+  void play(Ts... x) override { this->parent_->dump_stats(); }
 };
+#endif
 
 }  // namespace coulomb_meter
 }  // namespace esphome
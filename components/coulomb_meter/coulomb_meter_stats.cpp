@@ -0,0 +1,38 @@
+#include "coulomb_meter_stats.h"
+
+#ifdef USE_COULOMB_METER_STATS
+
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace coulomb_meter {
+
+static const char *const TAG = "CoulombMeter.stats";
+
+void CoulombMeterStats::update() {
+  if (this->meter_->get_histogram_resets() != this->published_resets_) {
+    // dump_stats() started the histograms over, the window does too
+    this->published_resets_ = this->meter_->get_histogram_resets();
+    for (auto &published : this->published_) {
+      published.clear();
+    }
+  }
+  for (uint8_t i = 0; i < HISTOGRAM_COUNT; i++) {
+    const LatencyHistogram &histogram = this->meter_->get_histogram((MeterHistogram) i);
+    if (this->sensors_[i] != nullptr) {
+      this->sensors_[i]->publish_state(histogram.percentile_us(this->percentile_, this->published_[i]));
+    }
+    this->published_[i] = histogram;
+  }
+}
+
+void CoulombMeterStats::dump_config() {
+  ESP_LOGCONFIG(TAG, "Coulomb Meter Stats:");
+  ESP_LOGCONFIG(TAG, "  Percentile: %.1f %%", this->percentile_ * 100);
+  LOG_UPDATE_INTERVAL(this);
+}
+
+}  // namespace coulomb_meter
+}  // namespace esphome
+
+#endif
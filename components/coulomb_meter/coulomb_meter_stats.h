@@ -0,0 +1,36 @@
+#pragma once
+
+#ifdef USE_COULOMB_METER_STATS
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "coulomb_meter.h"
+
+namespace esphome {
+namespace coulomb_meter {
+
+// Publishes a percentile of every latency histogram of a meter as diagnostic
+// sensors, over the samples since the previous update.
+class CoulombMeterStats : public PollingComponent {
+ public:
+  void set_meter(CoulombMeter *meter) { this->meter_ = meter; }
+  void set_percentile(float percentile) { this->percentile_ = percentile; }
+  void set_sensor(MeterHistogram histogram, sensor::Sensor *sensor) { this->sensors_[histogram] = sensor; }
+
+  void update() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+ protected:
+  CoulombMeter *meter_{nullptr};
+  float percentile_{0.99f};
+  sensor::Sensor *sensors_[HISTOGRAM_COUNT]{};
+  // histograms as of the previous update, the window starts there
+  LatencyHistogram published_[HISTOGRAM_COUNT]{};
+  uint32_t published_resets_{0};
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,87 @@
+#pragma once
+
+#include "esphome/components/sensor/sensor.h"
+#include <cstdint>
+
+namespace esphome {
+namespace coulomb_meter {
+
+// Flags sample intervals far beyond the usual one, when the loop stalled for
+// an OTA, a WiFi reconnect or a flash write. The drivers integrate a gap with
+// the trapezoid between the two samples around it instead of holding the new
+// sample over the whole stall. The nominal period is an EWMA of the intervals
+// that were no gap; after RESEED_GAPS gaps in a row the rate itself dropped,
+// and the latest interval seeds the period again. Integer only, for the I2C
+// interrupt as well.
+class GapDetector {
+ public:
+  // a gap is an interval above factor x the nominal period, 0 disables
+  void set_factor(float factor) { this->factor_x16_ = uint32_t(factor * 16); }
+  float get_factor() const { return this->factor_x16_ / 16.0f; }
+
+  // true when the interval is a gap, otherwise it updates the nominal period
+  bool check(uint32_t elapsed_us) {
+    if (this->nominal_x8_ == 0) {
+      // the first interval seeds the period
+      this->nominal_x8_ = uint64_t(elapsed_us) * 8;
+      return false;
+    }
+    if (this->factor_x16_ != 0 && uint64_t(elapsed_us) * 128 > this->nominal_x8_ * this->factor_x16_) {
+      if (++this->consecutive_gaps_ >= RESEED_GAPS) {
+        this->consecutive_gaps_ = 0;
+        this->nominal_x8_ = uint64_t(elapsed_us) * 8;
+        return false;
+      }
+      this->gaps_++;
+      this->gap_us_ += elapsed_us;
+      return true;
+    }
+    this->consecutive_gaps_ = 0;
+    // alpha 1/8
+    this->nominal_x8_ -= this->nominal_x8_ / 8;
+    this->nominal_x8_ += elapsed_us;
+    return false;
+  }
+
+  // folds in the gaps another detector saw, for the interrupt's detector
+  void add_gaps(uint32_t gaps, uint64_t gap_us) {
+    this->gaps_ += gaps;
+    this->gap_us_ += gap_us;
+  }
+
+  uint32_t get_nominal_us() const { return this->nominal_x8_ / 8; }
+  uint32_t get_gaps() const { return this->gaps_; }
+  uint64_t get_gap_us() const { return this->gap_us_; }
+
+ protected:
+  static const uint8_t RESEED_GAPS = 8;
+
+  uint32_t factor_x16_{5 * 16};
+  uint64_t nominal_x8_{0};
+  uint8_t consecutive_gaps_{0};
+  uint32_t gaps_{0};
+  uint64_t gap_us_{0};
+};
+
+// The optional gap count and total gap duration sensors of a driver.
+class GapSensors {
+ public:
+  void set_count_sensor(sensor::Sensor *sensor) { this->count_sensor_ = sensor; }
+  void set_duration_sensor(sensor::Sensor *sensor) { this->duration_sensor_ = sensor; }
+
+  void publish(const GapDetector &detector) {
+    if (this->count_sensor_ != nullptr) {
+      this->count_sensor_->publish_state(detector.get_gaps());
+    }
+    if (this->duration_sensor_ != nullptr) {
+      this->duration_sensor_->publish_state(detector.get_gap_us() / 1e6f);
+    }
+  }
+
+ protected:
+  sensor::Sensor *count_sensor_{nullptr};
+  sensor::Sensor *duration_sensor_{nullptr};
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
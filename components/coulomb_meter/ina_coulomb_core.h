@@ -0,0 +1,424 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/i2c/i2c.h"
+#include "coulomb_meter.h"
+#include "gap_detector.h"
+#include "sample_stats.h"
+#ifdef USE_COULOMB_METER_CAPTURE
+#include "waveform_capture.h"
+#endif
+#ifdef USE_COULOMB_METER_STREAM
+#include "sample_stream.h"
+#endif
+#ifdef USE_I2C_ASYNC
+#include "isr_integrator.h"
+#include "../i2c_async/i2c_async.h"
+#endif
+#include <cmath>
+
+namespace esphome {
+namespace coulomb_meter {
+
+// Sampling, integration and publishing shared by the INA drivers. A chip is
+// a traits struct of constexpr register addresses, layouts and LSBs:
+//
+//   struct Traits {
+//     static constexpr const char *TAG;
+//     static constexpr uint8_t REGISTER_CURRENT;        // integrated every tick
+//     static constexpr uint8_t REGISTER_BUS_VOLTAGE;    // every 20th tick
+//     static constexpr uint8_t REGISTER_SHUNT_VOLTAGE;  // on update()
+//     static constexpr uint8_t CURRENT_SHIFT;           // signed, left-aligned bits
+//     static constexpr uint8_t BUS_VOLTAGE_SHIFT;       // unsigned, status bits below
+//     static constexpr uint8_t SHUNT_VOLTAGE_SHIFT;
+//     static constexpr float BUS_VOLTAGE_LSB;           // V
+//     static constexpr float SHUNT_VOLTAGE_LSB;         // V
+//   };
+//
+// The driver configures the chip in its setup(), sets current_lsb_a_ (the
+// calibration LSB, or the shunt voltage LSB over the shunt resistance for
+// chips without a current register) and calls setup_core_(). The hot path,
+// calc_charge() and the I2C interrupt, is compiled per chip with the
+// constants folded in.
+template<typename Traits> class InaCoulombCore : public i2c::I2CDevice, public CoulombMeter {
+ public:
+  float get_setup_priority() const override { return setup_priority::DATA; }
+  void update() override;
+  void calc_charge();
+
+  void set_shunt_resistance_ohm(float shunt_resistance_ohm) { shunt_resistance_ohm_ = shunt_resistance_ohm; }
+  void set_max_current_a(float max_current_a) { max_current_a_ = max_current_a; }
+  void set_bus_voltage_calibration(float calibration) { bus_voltage_calibration_ = calibration; }
+
+  void set_bus_voltage_sensor(sensor::Sensor *bus_voltage_sensor) { bus_voltage_sensor_ = bus_voltage_sensor; }
+  void set_shunt_voltage_sensor(sensor::Sensor *shunt_voltage_sensor) { shunt_voltage_sensor_ = shunt_voltage_sensor; }
+  void set_current_sensor(sensor::Sensor *current_sensor) { current_sensor_ = current_sensor; }
+  void set_power_sensor(sensor::Sensor *power_sensor) { power_sensor_ = power_sensor; }
+  void set_charge_coulombs_sensor(sensor::Sensor *charge_coulombs_sensor) { charge_coulombs_sensor_ = charge_coulombs_sensor; }
+  void set_read_per_second_sensor(sensor::Sensor *read_per_second_sensor) { read_per_second_sensor_ = read_per_second_sensor; }
+
+  float get_voltage() final { return latest_voltage_.value_or(0); }
+  float get_current() final { return latest_current_; }
+  int64_t get_charge_c() final { return latest_charge_mc_ / 1000; }
+  int64_t get_energy_j() final { return latest_energy_mj_ / 1000; }
+
+  // statistics of every sample of an update interval
+  void set_current_stat_sensor(SampleStat stat, sensor::Sensor *sensor) { current_stats_sensors_.set_sensor(stat, sensor); }
+  void set_power_stat_sensor(SampleStat stat, sensor::Sensor *sensor) { power_stats_sensors_.set_sensor(stat, sensor); }
+  // intervals above factor x the nominal sample period are integrated as gaps
+  void set_gap_factor(float factor) { gap_detector_.set_factor(factor); }
+  void set_gap_count_sensor(sensor::Sensor *sensor) { gap_sensors_.set_count_sensor(sensor); }
+  void set_gap_duration_sensor(sensor::Sensor *sensor) { gap_sensors_.set_duration_sensor(sensor); }
+
+  #ifdef USE_COULOMB_METER_CAPTURE
+  void set_capture(WaveformCapture *capture) { capture_ = capture; }
+  #endif
+  #ifdef USE_COULOMB_METER_STREAM
+  void set_stream(SampleStream *stream) { stream_ = stream; }
+  #endif
+  #ifdef USE_I2C_ASYNC
+  // read in the background on an i2c_async bus, the integration runs in its interrupt
+  void set_async_bus(i2c_async::I2CAsyncBus *async_bus) { async_bus_ = async_bus; }
+  #endif
+
+ protected:
+  static int16_t to_current_(uint16_t raw) { return int16_t(raw) >> Traits::CURRENT_SHIFT; }
+  static int16_t to_bus_voltage_(uint16_t raw) { return int16_t(raw >> Traits::BUS_VOLTAGE_SHIFT); }
+
+  // the sinks, the sampling and the integration interval, once the chip runs
+  void setup_core_();
+  void dump_core_config_();
+
+  // register read of calc_charge(), timed for the latency histogram
+  bool read_sample_(uint8_t a_register, uint16_t *value) {
+    #ifdef USE_COULOMB_METER_STATS
+    const ScopedLatency timing(this->histograms_[HISTOGRAM_I2C_LATENCY]);
+    #endif
+    return this->read_byte_16(a_register, value);
+  }
+  // adds a step to the totals, whole mC and mJ move to the 64 bit counters
+  void accumulate_(float delta_mc, float delta_mj) {
+    this->partial_charge_mc_ += delta_mc;
+    const int64_t delta_int = (int64_t) this->partial_charge_mc_;
+    this->latest_charge_mc_ += delta_int;
+    this->partial_charge_mc_ -= delta_int;
+
+    this->partial_energy_mj_ += delta_mj;
+    const int64_t energy_int = (int64_t) this->partial_energy_mj_;
+    this->latest_energy_mj_ += energy_int;
+    this->partial_energy_mj_ -= energy_int;
+  }
+  void add_sample_stats_(int16_t raw_current) {
+    this->current_stats_.add(raw_current);
+    this->power_stats_.add((int32_t(raw_current) * this->latest_raw_voltage_) >> POWER_SAMPLE_SHIFT);
+  }
+  // publishes the statistics of the update interval and starts new ones
+  void publish_sample_stats_() {
+    this->current_stats_sensors_.publish(this->current_stats_, this->current_lsb_a_);
+    this->power_stats_sensors_.publish(this->power_stats_,
+                                       this->current_lsb_a_ * this->voltage_lsb_v_ * (1 << POWER_SAMPLE_SHIFT));
+    this->current_stats_.clear();
+    this->power_stats_.clear();
+  }
+  // capture and stream, from calc_charge() and the I2C interrupt
+  void feed_sample_sinks_(uint32_t time_us, int16_t raw_current) {
+    #ifdef USE_COULOMB_METER_CAPTURE
+    if (this->capture_ != nullptr) {
+      this->capture_->add(time_us, raw_current, this->latest_raw_voltage_);
+    }
+    #endif
+    #ifdef USE_COULOMB_METER_STREAM
+    if (this->stream_ != nullptr) {
+      this->stream_->add(time_us, raw_current, this->latest_raw_voltage_);
+    }
+    #endif
+  }
+
+  float shunt_resistance_ohm_;
+  float max_current_a_;
+  float bus_voltage_calibration_{1};
+  // calibration LSB of the current register in µA, 0 for chips without one
+  uint32_t calibration_lsb_{0};
+  // A and V per raw step, set before setup_core_()
+  float current_lsb_a_{0};
+  float voltage_lsb_v_{0};
+  // the channels of a multi-channel chip share one interval in their parent
+  bool sampled_by_parent_{false};
+
+  SampleStats current_stats_;
+  // raw current x raw bus voltage >> POWER_SAMPLE_SHIFT
+  SampleStats power_stats_;
+  SampleStatsSensors current_stats_sensors_;
+  SampleStatsSensors power_stats_sensors_;
+  GapDetector gap_detector_;
+  GapSensors gap_sensors_;
+  int16_t latest_raw_voltage_{0};
+
+  #ifdef USE_COULOMB_METER_CAPTURE
+  WaveformCapture *capture_{nullptr};
+  #endif
+  #ifdef USE_COULOMB_METER_STREAM
+  SampleStream *stream_{nullptr};
+  #endif
+
+  #ifdef USE_I2C_ASYNC
+  static void on_async_read_(void *arg, uint8_t a_register, uint16_t value, int64_t time_us);
+  // drains the interrupt's sums and queues the next reads
+  void calc_charge_async_();
+
+  i2c_async::I2CAsyncBus *async_bus_{nullptr};
+  i2c_async::AsyncRegisterReader *async_reader_{nullptr};
+  IsrIntegrator integrator_;
+  uint32_t async_errors_{0};
+  #endif
+
+  int64_t latest_energy_mj_{0};
+  int64_t latest_charge_mc_{0};
+  float partial_energy_mj_{0};
+  float partial_charge_mc_{0};
+
+  sensor::Sensor *bus_voltage_sensor_{nullptr};
+  sensor::Sensor *shunt_voltage_sensor_{nullptr};
+  sensor::Sensor *current_sensor_{nullptr};
+  sensor::Sensor *power_sensor_{nullptr};
+  sensor::Sensor *charge_coulombs_sensor_{nullptr};
+  sensor::Sensor *read_per_second_sensor_{nullptr};
+
+  optional<float> latest_voltage_;
+  float latest_current_{0};
+
+  uint32_t reads_count_{0};
+  uint32_t previous_time_{0};
+
+  uint32_t charge_reads_count_{0};
+  uint32_t charge_read_time_{0};
+};
+
+template<typename Traits> void InaCoulombCore<Traits>::setup_core_() {
+  this->voltage_lsb_v_ = Traits::BUS_VOLTAGE_LSB * this->bus_voltage_calibration_;
+
+  #ifdef USE_COULOMB_METER_CAPTURE
+  if (this->capture_ != nullptr) {
+    this->capture_->setup(this->current_lsb_a_, this->voltage_lsb_v_);
+  }
+  #endif
+
+  #ifdef USE_COULOMB_METER_STREAM
+  if (this->stream_ != nullptr) {
+    this->stream_->set_scale(this->current_lsb_a_, this->voltage_lsb_v_);
+  }
+  #endif
+
+  #ifdef USE_I2C_ASYNC
+  if (this->async_bus_ != nullptr) {
+    this->integrator_.set_gap_factor(this->gap_detector_.get_factor());
+    this->async_reader_ = this->async_bus_->add_reader(this->address_, InaCoulombCore::on_async_read_, this);
+    if (this->async_reader_ == nullptr) {
+      this->mark_failed();
+      return;
+    }
+  }
+  #endif
+
+  this->CoulombMeter::setup();
+
+  this->disable_loop();
+
+  if (!this->sampled_by_parent_) {
+    this->set_interval("calcCharge", 1, [this]() {
+      this->calc_charge();
+    });
+  }
+
+  this->previous_time_ = App.get_loop_component_start_time();
+  this->charge_read_time_ = App.get_loop_component_start_time();
+}
+
+template<typename Traits> void InaCoulombCore<Traits>::dump_core_config_() {
+  // the LOG_* macros log to TAG
+  static constexpr const char *TAG = Traits::TAG;
+  LOG_UPDATE_INTERVAL(this);
+
+  LOG_SENSOR("  ", "Bus Voltage", this->bus_voltage_sensor_);
+  LOG_SENSOR("  ", "Shunt Voltage", this->shunt_voltage_sensor_);
+  LOG_SENSOR("  ", "Current", this->current_sensor_);
+  LOG_SENSOR("  ", "Power", this->power_sensor_);
+  ESP_LOGCONFIG(TAG, "  Gap Factor: %.1f", this->gap_detector_.get_factor());
+  #ifdef USE_COULOMB_METER_CAPTURE
+  if (this->capture_ != nullptr) {
+    this->capture_->dump_config(TAG);
+  }
+  #endif
+  #ifdef USE_I2C_ASYNC
+  if (this->async_reader_ != nullptr) {
+    ESP_LOGCONFIG(TAG, "  Background reads: YES");
+  }
+  #endif
+}
+
+template<typename Traits> void InaCoulombCore<Traits>::update() {
+  if (this->current_sensor_ != nullptr) {
+    this->current_sensor_->publish_state(this->latest_current_);
+  }
+
+  if (this->bus_voltage_sensor_ != nullptr && this->latest_voltage_.has_value()) {
+    this->bus_voltage_sensor_->publish_state(this->latest_voltage_.value());
+  }
+
+  if (this->power_sensor_ != nullptr && this->latest_voltage_.has_value()) {
+    this->power_sensor_->publish_state(this->latest_voltage_.value() * this->latest_current_);
+  }
+
+  if (this->charge_coulombs_sensor_ != nullptr) {
+    this->charge_coulombs_sensor_->publish_state(this->get_charge_c());
+  }
+
+  this->publish_sample_stats_();
+  this->gap_sensors_.publish(this->gap_detector_);
+
+  if (this->read_per_second_sensor_ != nullptr) {
+    auto const now = App.get_loop_component_start_time();
+    auto const elapsed_s = (now - this->charge_read_time_) / 1000.0f;
+    if (elapsed_s != 0) {
+      const auto reads_per_second = static_cast<float>(this->charge_reads_count_) / elapsed_s;
+      this->read_per_second_sensor_->publish_state(reads_per_second);
+    }
+    // start a new measurement interval for the reads per second
+    this->charge_reads_count_ = 0;
+    this->charge_read_time_ = now;
+  }
+
+  if (this->shunt_voltage_sensor_ != nullptr) {
+    uint16_t raw_shunt_voltage;
+    if (!this->read_byte_16(Traits::REGISTER_SHUNT_VOLTAGE, &raw_shunt_voltage)) {
+      this->status_set_warning("Failed to read shunt voltage");
+      return;
+    }
+    const int16_t shunt_voltage = int16_t(raw_shunt_voltage) >> Traits::SHUNT_VOLTAGE_SHIFT;
+    this->shunt_voltage_sensor_->publish_state(shunt_voltage * Traits::SHUNT_VOLTAGE_LSB);
+  }
+
+  this->status_clear_warning();
+}
+
+template<typename Traits> void InaCoulombCore<Traits>::calc_charge() {
+  #ifdef USE_COULOMB_METER_STATS
+  const ScopedLatency timing(this->histograms_[HISTOGRAM_CALC_CHARGE]);
+  #endif
+  #ifdef USE_COULOMB_METER_CAPTURE
+  if (this->capture_ != nullptr) {
+    this->capture_->poll();
+  }
+  #endif
+  #ifdef USE_I2C_ASYNC
+  if (this->async_reader_ != nullptr) {
+    this->calc_charge_async_();
+    return;
+  }
+  #endif
+  const auto now = App.get_loop_component_start_time();
+
+  if (now == this->previous_time_) {
+    // skip if called too fast (less than 1ms)
+    return;
+  }
+  if (this->reads_count_ == 1) {
+    uint16_t raw_bus_voltage;
+    if (this->read_sample_(Traits::REGISTER_BUS_VOLTAGE, &raw_bus_voltage)) {
+      this->latest_raw_voltage_ = to_bus_voltage_(raw_bus_voltage);
+      this->latest_voltage_ = this->latest_raw_voltage_ * this->voltage_lsb_v_;
+    } else {
+      this->status_set_warning("Failed to read bus voltage");
+    }
+  } else if (this->reads_count_ >= 20) {
+    this->reads_count_ = 0;
+  }
+  this->reads_count_++;
+
+  uint16_t value;
+  if (!this->read_sample_(Traits::REGISTER_CURRENT, &value)) {
+    this->status_set_warning("Failed to read current");
+    return;
+  }
+  const int16_t raw_current = to_current_(value);
+  const float current_a = raw_current * this->current_lsb_a_;
+
+  const float previous_current_a = this->latest_current_;
+  this->latest_current_ = current_a;
+  this->add_sample_stats_(raw_current);
+  this->feed_sample_sinks_(micros(), raw_current);
+
+  const uint32_t elapsed_ms = now - this->previous_time_;
+  float delta_mc;
+  if (this->gap_detector_.check(elapsed_ms * 1000)) {
+    // the loop stalled, interpolate between the samples around the gap
+    delta_mc = (previous_current_a + current_a) / 2 * elapsed_ms;
+  } else {
+    delta_mc = current_a * elapsed_ms;
+  }
+
+  this->accumulate_(delta_mc, this->latest_voltage_.value_or(0) * delta_mc);
+
+  this->previous_time_ = now;
+  #ifdef USE_COULOMB_METER_STATS
+  this->record_sample_();
+  #endif
+
+  this->charge_reads_count_++;
+}
+
+#ifdef USE_I2C_ASYNC
+template<typename Traits>
+void IRAM_ATTR InaCoulombCore<Traits>::on_async_read_(void *arg, uint8_t a_register, uint16_t value, int64_t time_us) {
+  auto *ina = static_cast<InaCoulombCore *>(arg);
+  if (a_register == Traits::REGISTER_CURRENT) {
+    const int16_t raw_current = to_current_(value);
+    ina->integrator_.add_current(raw_current, time_us);
+    ina->feed_sample_sinks_(time_us, raw_current);
+  } else if (a_register == Traits::REGISTER_BUS_VOLTAGE) {
+    ina->latest_raw_voltage_ = to_bus_voltage_(value);
+    ina->integrator_.set_voltage(ina->latest_raw_voltage_);
+  }
+}
+
+template<typename Traits> void InaCoulombCore<Traits>::calc_charge_async_() {
+  const auto sums = this->integrator_.drain();
+  if (sums.has_voltage) {
+    this->latest_voltage_ = sums.voltage * this->voltage_lsb_v_;
+  }
+  if (sums.samples != 0) {
+    this->latest_current_ = sums.current * this->current_lsb_a_;
+    // raw x µs to mC: A x 1e-6 s = 1e-3 mC
+    const float mc_per_raw_us = this->current_lsb_a_ * 1e-3f;
+    this->accumulate_(sums.current_us * mc_per_raw_us, sums.power_us * mc_per_raw_us * this->voltage_lsb_v_);
+    this->charge_reads_count_ += sums.samples;
+  }
+  this->gap_detector_.add_gaps(sums.gaps, sums.gap_us);
+  this->current_stats_.merge(sums.current_stats);
+  this->power_stats_.merge(sums.power_stats);
+
+  const uint32_t errors = this->async_reader_->get_errors();
+  if (errors != this->async_errors_) {
+    this->async_errors_ = errors;
+    this->status_set_warning("Failed to read current");
+  }
+
+  // the last reads are still on the bus, the next tick queues new ones
+  if (this->async_reader_->get_pending() != 0) {
+    return;
+  }
+  if (this->reads_count_ == 1) {
+    this->async_reader_->read_register16(Traits::REGISTER_BUS_VOLTAGE);
+  } else if (this->reads_count_ >= 20) {
+    this->reads_count_ = 0;
+  }
+  this->reads_count_++;
+  this->async_reader_->read_register16(Traits::REGISTER_CURRENT);
+}
+#endif
+
+}  // namespace coulomb_meter
+}  // namespace esphome
@@ -0,0 +1,99 @@
+#pragma once
+
+#ifdef USE_I2C_ASYNC
+
+#include "esphome/core/hal.h"
+#include "gap_detector.h"
+#include "sample_stats.h"
+#include <freertos/FreeRTOS.h>
+#include <cstdint>
+
+namespace esphome {
+namespace coulomb_meter {
+
+// Integrates raw INA register values in the I2C interrupt, for drivers that
+// read in the background. Integer only: the ESP32 does not save the FPU
+// registers for interrupt handlers. The loop drains the sums and scales them
+// with the register LSBs, with at most a few ms between drains the products
+// stay far from overflowing.
+class IsrIntegrator {
+ public:
+  struct Sums {
+    // raw current x µs, rectangle rule with the new sample over the past interval
+    int64_t current_us{0};
+    // raw current x raw bus voltage x µs
+    int64_t power_us{0};
+    uint32_t samples{0};
+    // intervals integrated as gaps and their total length
+    uint32_t gaps{0};
+    uint64_t gap_us{0};
+    // raw current and power (POWER_SAMPLE_SHIFT) samples
+    SampleStats current_stats;
+    SampleStats power_stats;
+    // latest raw values
+    int16_t current{0};
+    int16_t voltage{0};
+    bool has_voltage{false};
+  };
+
+  void set_gap_factor(float factor) { this->gap_.set_factor(factor); }
+
+  void IRAM_ATTR add_current(int16_t raw, int64_t time_us) {
+    portENTER_CRITICAL_ISR(&this->lock_);
+    if (this->has_time_) {
+      const int64_t elapsed_us = time_us - this->previous_us_;
+      if (this->gap_.check(elapsed_us)) {
+        // trapezoid between the samples around the gap
+        const int64_t raw_sum = int32_t(raw) + this->sums_.current;
+        this->sums_.current_us += raw_sum * elapsed_us / 2;
+        this->sums_.power_us += raw_sum * this->sums_.voltage * elapsed_us / 2;
+        this->sums_.gaps++;
+        this->sums_.gap_us += elapsed_us;
+      } else {
+        this->sums_.current_us += raw * elapsed_us;
+        this->sums_.power_us += int32_t(raw) * this->sums_.voltage * elapsed_us;
+      }
+      this->sums_.samples++;
+    }
+    this->sums_.current_stats.add(raw);
+    this->sums_.power_stats.add((int32_t(raw) * this->sums_.voltage) >> POWER_SAMPLE_SHIFT);
+    this->previous_us_ = time_us;
+    this->has_time_ = true;
+    this->sums_.current = raw;
+    portEXIT_CRITICAL_ISR(&this->lock_);
+  }
+
+  void IRAM_ATTR set_voltage(int16_t raw) {
+    portENTER_CRITICAL_ISR(&this->lock_);
+    this->sums_.voltage = raw;
+    this->sums_.has_voltage = true;
+    portEXIT_CRITICAL_ISR(&this->lock_);
+  }
+
+  // the sums since the last drain, the latest values stay
+  Sums drain() {
+    portENTER_CRITICAL(&this->lock_);
+    const Sums sums = this->sums_;
+    this->sums_.current_us = 0;
+    this->sums_.power_us = 0;
+    this->sums_.samples = 0;
+    this->sums_.gaps = 0;
+    this->sums_.gap_us = 0;
+    this->sums_.current_stats.clear();
+    this->sums_.power_stats.clear();
+    portEXIT_CRITICAL(&this->lock_);
+    return sums;
+  }
+
+ protected:
+  portMUX_TYPE lock_ = portMUX_INITIALIZER_UNLOCKED;
+  Sums sums_;
+  GapDetector gap_;
+  int64_t previous_us_{0};
+  bool has_time_{false};
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
+
+#endif
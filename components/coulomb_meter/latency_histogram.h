@@ -0,0 +1,71 @@
+#pragma once
+
+#include "esphome/core/hal.h"
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace coulomb_meter {
+
+// Durations in µs, counted in power of two buckets: bucket 0 is [0, 2) µs,
+// bucket i is [2^i, 2^(i+1)) µs, the last one takes everything from 2^15 µs.
+// Adding is a count leading zeros and an increment, cheap enough for the hot path.
+struct LatencyHistogram {
+  static const uint8_t BUCKETS = 16;
+
+  uint32_t counts[BUCKETS];
+  uint32_t count;
+  uint32_t max_us;
+  uint64_t total_us;
+
+  void clear() { *this = {}; }
+
+  void add(uint32_t us) {
+    uint8_t bucket = us < 2 ? 0 : 31 - __builtin_clz(us);
+    if (bucket >= BUCKETS) {
+      bucket = BUCKETS - 1;
+    }
+    this->counts[bucket]++;
+    this->count++;
+    this->total_us += us;
+    if (us > this->max_us) {
+      this->max_us = us;
+    }
+  }
+
+  static uint32_t bucket_end_us(uint8_t bucket) { return 2UL << bucket; }
+
+  // upper bound of the bucket holding the given fraction of the samples counted
+  // since `since`, the same histogram at an earlier time; NAN without samples
+  float percentile_us(float fraction, const LatencyHistogram &since) const {
+    const uint32_t samples = this->count - since.count;
+    if (samples == 0) {
+      return NAN;
+    }
+    const uint32_t rank = (uint32_t) (fraction * (samples - 1)) + 1;
+    uint32_t seen = 0;
+    for (uint8_t i = 0; i < BUCKETS - 1; i++) {
+      seen += this->counts[i] - since.counts[i];
+      if (seen >= rank) {
+        return bucket_end_us(i);
+      }
+    }
+    // open ended, the largest sample is the best bound there is
+    return this->max_us;
+  }
+};
+
+// Scope guard for duration histograms, records when it goes out of scope so
+// early returns are counted too.
+class ScopedLatency {
+ public:
+  explicit ScopedLatency(LatencyHistogram &histogram) : histogram_(histogram), start_us_(micros()) {}
+  ~ScopedLatency() { this->histogram_.add(micros() - this->start_us_); }
+
+ protected:
+  LatencyHistogram &histogram_;
+  uint32_t start_us_;
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "esphome/components/sensor/sensor.h"
+#include <cmath>
+#include <cstdint>
+
+namespace esphome {
+namespace coulomb_meter {
+
+enum SampleStat : uint8_t {
+  SAMPLE_STAT_MIN,
+  SAMPLE_STAT_MAX,
+  SAMPLE_STAT_MEAN,
+  SAMPLE_STAT_RMS,
+  // peak to peak, max - min
+  SAMPLE_STAT_RIPPLE,
+  SAMPLE_STAT_COUNT,
+};
+
+// raw current x raw bus voltage reaches 2^30, power samples are shifted into the 2^20 range
+static const uint8_t POWER_SAMPLE_SHIFT = 10;
+
+// Min, max, mean and RMS of raw register samples over one update interval.
+// Integer only and O(1) per sample, for calc_charge() at 1 kHz and the I2C
+// interrupt. Values up to 2^20 keep the sum of squares below 2^63 for 2^23
+// samples, over two hours at 1 kHz.
+struct SampleStats {
+  int32_t min{INT32_MAX};
+  int32_t max{INT32_MIN};
+  int64_t sum{0};
+  uint64_t sum_sq{0};
+  uint32_t count{0};
+
+  void clear() { *this = SampleStats{}; }
+
+  void add(int32_t raw) {
+    if (raw < this->min) {
+      this->min = raw;
+    }
+    if (raw > this->max) {
+      this->max = raw;
+    }
+    this->sum += raw;
+    this->sum_sq += uint64_t(int64_t(raw) * raw);
+    this->count++;
+  }
+
+  void merge(const SampleStats &other) {
+    if (other.count == 0) {
+      return;
+    }
+    if (other.min < this->min) {
+      this->min = other.min;
+    }
+    if (other.max > this->max) {
+      this->max = other.max;
+    }
+    this->sum += other.sum;
+    this->sum_sq += other.sum_sq;
+    this->count += other.count;
+  }
+
+  // in units of scale per raw step, NAN without samples
+  float get(SampleStat stat, float scale) const {
+    if (this->count == 0) {
+      return NAN;
+    }
+    switch (stat) {
+      case SAMPLE_STAT_MIN:
+        return this->min * scale;
+      case SAMPLE_STAT_MAX:
+        return this->max * scale;
+      case SAMPLE_STAT_MEAN:
+        return (float) this->sum / this->count * scale;
+      case SAMPLE_STAT_RMS:
+        return sqrtf((float) this->sum_sq / this->count) * std::fabs(scale);
+      case SAMPLE_STAT_RIPPLE:
+        return (this->max - this->min) * std::fabs(scale);
+      default:
+        return NAN;
+    }
+  }
+};
+
+// The optional sensors for the statistics of one quantity.
+class SampleStatsSensors {
+ public:
+  void set_sensor(SampleStat stat, sensor::Sensor *sensor) { this->sensors_[stat] = sensor; }
+
+  void publish(const SampleStats &stats, float scale) {
+    for (uint8_t i = 0; i < SAMPLE_STAT_COUNT; i++) {
+      if (this->sensors_[i] != nullptr) {
+        this->sensors_[i]->publish_state(stats.get((SampleStat) i, scale));
+      }
+    }
+  }
+
+ protected:
+  sensor::Sensor *sensors_[SAMPLE_STAT_COUNT]{};
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
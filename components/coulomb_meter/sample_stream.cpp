@@ -0,0 +1,186 @@
+#include "sample_stream.h"
+
+#ifdef USE_COULOMB_METER_STREAM
+
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+namespace esphome {
+namespace coulomb_meter {
+
+static const char *const TAG = "CoulombMeter.stream";
+
+static const uint8_t SYNC_1 = 0xA5;
+static const uint8_t SYNC_2 = 0x5A;
+static const uint8_t INFO_VERSION = 1;
+// sample frames between two info frames
+static const uint16_t INFO_INTERVAL = 256;
+// the ESP32 UART hardware FIFO; writes beyond it wait for the line
+static const uint32_t TX_FIFO_SIZE = 128;
+// 8N1: 10 bits per byte, bytes on the line = µs x baud / 1e7
+static const uint64_t LINE_US_SCALE = 10000000;
+
+static uint16_t crc16_ccitt(const uint8_t *data, size_t len) {
+  uint16_t crc = 0xFFFF;
+  for (size_t i = 0; i < len; i++) {
+    crc ^= uint16_t(data[i]) << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) {
+      crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+    }
+  }
+  return crc;
+}
+
+void SampleStream::setup() {
+  this->ring_.reset(new uint8_t[this->buffer_size_]);  // NOLINT(cppcoreguidelines-owning-memory)
+  this->line_us_ = micros();
+}
+
+void SampleStream::set_enabled(bool enabled) {
+  if (enabled && !this->enabled_.load()) {
+    // the decoder may have been started in between
+    this->info_due_.store(true);
+  }
+  this->enabled_.store(enabled);
+}
+
+void SampleStream::put_varint_(uint32_t value) {
+  while (value >= 0x80) {
+    this->frame_[this->frame_len_++] = (value & 0x7F) | 0x80;
+    value >>= 7;
+  }
+  this->frame_[this->frame_len_++] = value;
+}
+
+bool SampleStream::push_frame_() {
+  const uint8_t payload_len = this->frame_len_ - 3;
+  this->frame_[0] = SYNC_1;
+  this->frame_[1] = SYNC_2;
+  this->frame_[2] = payload_len;
+  const uint16_t crc = crc16_ccitt(this->frame_ + 2, payload_len + 1);
+  this->frame_[this->frame_len_++] = crc & 0xFF;
+  this->frame_[this->frame_len_++] = crc >> 8;
+
+  const uint32_t head = this->ring_head_.load();
+  const uint32_t used = head - this->ring_tail_.load();
+  if (this->buffer_size_ - used < this->frame_len_) {
+    return false;
+  }
+  for (uint8_t i = 0; i < this->frame_len_; i++) {
+    this->ring_[(head + i) & (this->buffer_size_ - 1)] = this->frame_[i];
+  }
+  this->ring_head_.store(head + this->frame_len_);
+  return true;
+}
+
+void SampleStream::push_info_() {
+  this->frame_len_ = 3;
+  this->frame_[this->frame_len_++] = STREAM_FRAME_INFO;
+  this->frame_[this->frame_len_++] = INFO_VERSION;
+  memcpy(this->frame_ + this->frame_len_, &this->current_lsb_a_, sizeof(float));
+  this->frame_len_ += sizeof(float);
+  memcpy(this->frame_ + this->frame_len_, &this->voltage_lsb_v_, sizeof(float));
+  this->frame_len_ += sizeof(float);
+  if (this->push_frame_()) {
+    this->info_due_.store(false);
+    this->frames_since_info_ = 0;
+  }
+}
+
+void SampleStream::add(uint32_t time_us, int16_t current, int16_t voltage) {
+  if (!this->enabled_.load() || this->ring_ == nullptr) {
+    // a frame in progress is dropped, the next one starts with absolute values
+    this->frame_records_ = 0;
+    return;
+  }
+  if (this->frame_records_ == 0) {
+    if (this->info_due_.load()) {
+      this->push_info_();
+    }
+    this->frame_len_ = 3;
+    this->frame_[this->frame_len_++] = STREAM_FRAME_SAMPLES;
+    this->frame_[this->frame_len_++] = this->sequence_;
+    this->frame_[this->frame_len_++] = this->dropped_pending_ & 0xFF;
+    this->frame_[this->frame_len_++] = this->dropped_pending_ >> 8;
+    for (uint8_t i = 0; i < 4; i++) {
+      this->frame_[this->frame_len_++] = (time_us >> (8 * i)) & 0xFF;
+    }
+    this->frame_[this->frame_len_++] = uint16_t(current) & 0xFF;
+    this->frame_[this->frame_len_++] = uint16_t(current) >> 8;
+    this->frame_[this->frame_len_++] = uint16_t(voltage) & 0xFF;
+    this->frame_[this->frame_len_++] = uint16_t(voltage) >> 8;
+  } else {
+    this->put_varint_(time_us - this->previous_time_us_);
+    this->put_zigzag_(int32_t(current) - this->previous_current_);
+    this->put_zigzag_(int32_t(voltage) - this->previous_voltage_);
+  }
+  this->previous_time_us_ = time_us;
+  this->previous_current_ = current;
+  this->previous_voltage_ = voltage;
+
+  if (++this->frame_records_ < this->records_per_frame_) {
+    return;
+  }
+  if (this->push_frame_()) {
+    this->sequence_++;
+    this->dropped_pending_ = 0;
+    if (++this->frames_since_info_ >= INFO_INTERVAL) {
+      this->info_due_.store(true);
+    }
+  } else {
+    this->dropped_pending_ = std::min<uint32_t>(uint32_t(this->dropped_pending_) + this->frame_records_, UINT16_MAX);
+    this->dropped_total_ += this->frame_records_;
+  }
+  this->frame_records_ = 0;
+}
+
+void SampleStream::loop() {
+  const uint32_t now = micros();
+  const uint32_t baud_rate = this->parent_->get_baud_rate();
+  uint32_t credit = uint64_t(now - this->line_us_) * baud_rate / LINE_US_SCALE;
+  if (credit > TX_FIFO_SIZE) {
+    // the line was idle, at most a FIFO can go out without waiting
+    credit = TX_FIFO_SIZE;
+    this->line_us_ = now - TX_FIFO_SIZE * LINE_US_SCALE / baud_rate;
+  }
+
+  const uint32_t tail = this->ring_tail_.load();
+  const uint32_t available = this->ring_head_.load() - tail;
+  uint32_t len = std::min(credit, available);
+  if (len == 0) {
+    return;
+  }
+  // the ring wraps, write up to its end first
+  const uint32_t start = tail & (this->buffer_size_ - 1);
+  const uint32_t first = std::min<uint32_t>(len, this->buffer_size_ - start);
+  this->write_array(this->ring_.get() + start, first);
+  if (first < len) {
+    this->write_array(this->ring_.get(), len - first);
+  }
+  this->ring_tail_.store(tail + len);
+  this->line_us_ += uint64_t(len) * LINE_US_SCALE / baud_rate;
+  this->sent_bytes_ += len;
+}
+
+void SampleStream::update() {
+  if (this->dropped_records_sensor_ != nullptr) {
+    this->dropped_records_sensor_->publish_state(this->dropped_total_.load());
+  }
+}
+
+void SampleStream::dump_config() {
+  ESP_LOGCONFIG(TAG, "Coulomb Meter Sample Stream:");
+  ESP_LOGCONFIG(TAG, "  Buffer: %u bytes, %u records per frame", this->buffer_size_, this->records_per_frame_);
+  ESP_LOGCONFIG(TAG, "  Sent: %" PRIu32 " bytes, dropped records: %" PRIu32, this->sent_bytes_,
+                this->dropped_total_.load());
+  LOG_UPDATE_INTERVAL(this);
+  LOG_SENSOR("  ", "Dropped Records", this->dropped_records_sensor_);
+}
+
+}  // namespace coulomb_meter
+}  // namespace esphome
+
+#endif
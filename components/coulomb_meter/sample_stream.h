@@ -0,0 +1,119 @@
+#pragma once
+
+#ifdef USE_COULOMB_METER_STREAM
+
+#include "esphome/core/component.h"
+#include "esphome/core/automation.h"
+#include "esphome/components/sensor/sensor.h"
+#include "esphome/components/uart/uart.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+namespace esphome {
+namespace coulomb_meter {
+
+enum StreamFrameType : uint8_t {
+  STREAM_FRAME_SAMPLES = 0,
+  STREAM_FRAME_INFO = 1,
+};
+
+// Streams every raw INA sample to a UART as framed, delta-encoded records,
+// decoded on the host by tools/ina_stream_decode.py. Frame layout:
+//
+//   0xA5 0x5A, uint8 payload length, payload, uint16 CRC-16/CCITT-FALSE of
+//   length and payload. All multi-byte fields little-endian.
+//
+//   samples payload: uint8 type (0), uint8 sequence, uint16 records dropped
+//   before this frame (saturated), uint32 time_us, int16 raw current, int16
+//   raw bus voltage of the first record; then per record LEB128 varints of
+//   the µs since the previous record and zigzag current and voltage deltas.
+//
+//   info payload: uint8 type (1), uint8 version (1), float A per raw current
+//   step, float V per raw bus voltage step. Sent at start and every 256
+//   sample frames.
+//
+// add() runs in the sampling path (calc_charge() or the I2C interrupt): it
+// encodes into a frame and copies finished frames into a ring allocated in
+// setup(), without locks or allocation. A full ring drops the frame and
+// counts its records. loop() drains the ring at the UART's line rate, at
+// most a TX FIFO of bytes ahead, so the UART write never blocks the loop.
+class SampleStream : public PollingComponent, public uart::UARTDevice {
+ public:
+  void setup() override;
+  void loop() override;
+  void update() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void set_buffer_size(uint16_t buffer_size) { this->buffer_size_ = buffer_size; }
+  void set_records_per_frame(uint8_t records_per_frame) { this->records_per_frame_ = records_per_frame; }
+  void set_enabled(bool enabled);
+  void set_dropped_records_sensor(sensor::Sensor *sensor) { this->dropped_records_sensor_ = sensor; }
+  // raw steps of the INA, called by the driver's setup()
+  void set_scale(float current_lsb_a, float voltage_lsb_v) {
+    this->current_lsb_a_ = current_lsb_a;
+    this->voltage_lsb_v_ = voltage_lsb_v;
+  }
+
+  void add(uint32_t time_us, int16_t current, int16_t voltage);
+
+  uint32_t get_dropped_records() const { return this->dropped_total_.load(); }
+
+  // 12 byte first record, at most 11 bytes per further record, within the uint8 length
+  static const uint8_t MAX_RECORDS_PER_FRAME = 20;
+
+ protected:
+  static const uint8_t FRAME_SIZE = 3 + 12 + (MAX_RECORDS_PER_FRAME - 1) * 11 + 2;
+
+  void put_varint_(uint32_t value);
+  void put_zigzag_(int32_t value) { this->put_varint_((uint32_t(value) << 1) ^ uint32_t(value >> 31)); }
+  // CRC, then into the ring; false when the ring is full
+  bool push_frame_();
+  void push_info_();
+
+  uint16_t buffer_size_{4096};
+  uint8_t records_per_frame_{16};
+  float current_lsb_a_{0};
+  float voltage_lsb_v_{0};
+  sensor::Sensor *dropped_records_sensor_{nullptr};
+
+  // producer side, only touched by add()
+  uint8_t frame_[FRAME_SIZE];
+  uint8_t frame_len_{0};
+  uint8_t frame_records_{0};
+  uint8_t sequence_{0};
+  uint16_t frames_since_info_{0};
+  uint16_t dropped_pending_{0};
+  uint32_t previous_time_us_{0};
+  int16_t previous_current_{0};
+  int16_t previous_voltage_{0};
+
+  // single producer, single consumer ring; indices run freely, masked by the
+  // power of two buffer_size_ so they stay consistent across the 2^32 wrap
+  std::unique_ptr<uint8_t[]> ring_;
+  std::atomic<uint32_t> ring_head_{0};
+  std::atomic<uint32_t> ring_tail_{0};
+
+  std::atomic<bool> enabled_{true};
+  std::atomic<bool> info_due_{true};
+  std::atomic<uint32_t> dropped_total_{0};
+  uint32_t sent_bytes_{0};
+  // line time accounted for up to here
+  uint32_t line_us_{0};
+};
+
+template<typename... Ts> class StreamStartAction : public Action<Ts...>, public Parented<SampleStream> {
+ public:
+  void play(Ts... x) override { this->parent_->set_enabled(true); }
+};
+
+template<typename... Ts> class StreamStopAction : public Action<Ts...>, public Parented<SampleStream> {
+ public:
+  void play(Ts... x) override { this->parent_->set_enabled(false); }
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,36 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import CONF_CURRENT, CONF_ID, CONF_VOLTAGE
+
+from . import COULOMB_SCHEMA, CoulombMeter_ns, coulomb_meter_ns, setup_coulomb
+
+DEPENDENCIES = ["sensor"]
+
+SensorCoulombMeter = coulomb_meter_ns.class_("SensorCoulombMeter", CoulombMeter_ns)
+
+# the coulomb meter over any current and voltage sensor, integrated whenever
+# the current sensor publishes
+CONFIG_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(SensorCoulombMeter),
+            cv.Required(CONF_CURRENT): cv.use_id(sensor.Sensor),
+            cv.Required(CONF_VOLTAGE): cv.use_id(sensor.Sensor),
+        }
+    )
+    .extend(cv.polling_component_schema("60s"))
+    .extend(COULOMB_SCHEMA)
+)
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+
+    current = await cg.get_variable(config[CONF_CURRENT])
+    cg.add(var.set_current_source(current))
+    voltage = await cg.get_variable(config[CONF_VOLTAGE])
+    cg.add(var.set_voltage_source(voltage))
+
+    await setup_coulomb(var, config)
+    await cg.register_component(var, config)
@@ -0,0 +1,65 @@
+#include "sensor_coulomb_meter.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include <cmath>
+
+namespace esphome {
+namespace coulomb_meter {
+
+static const char *const TAG = "CoulombMeter.sensor";
+
+void SensorCoulombMeter::setup() {
+  this->current_source_->add_on_state_callback([this](float state) { this->on_current_(state); });
+  this->voltage_source_->add_on_state_callback([this](float state) {
+    if (!std::isnan(state)) {
+      this->latest_voltage_ = state;
+    }
+  });
+  if (this->voltage_source_->has_state() && !std::isnan(this->voltage_source_->get_state())) {
+    this->latest_voltage_ = this->voltage_source_->get_state();
+  }
+
+  this->CoulombMeter::setup();
+}
+
+void SensorCoulombMeter::dump_config() {
+  ESP_LOGCONFIG(TAG, "Sensor Coulomb Meter:");
+  LOG_UPDATE_INTERVAL(this);
+  LOG_SENSOR("  ", "Current Source", this->current_source_);
+  LOG_SENSOR("  ", "Voltage Source", this->voltage_source_);
+}
+
+void SensorCoulombMeter::on_current_(float current_a) {
+  if (std::isnan(current_a)) {
+    this->has_previous_ = false;
+    return;
+  }
+  // the ms steps of the time stamps add up exactly over the intervals
+  const uint32_t now = millis();
+  const float power_w = current_a * this->latest_voltage_;
+  if (this->has_previous_) {
+    const float elapsed_ms = now - this->previous_ms_;
+    const float delta_mc = (this->latest_current_ + current_a) / 2 * elapsed_ms;
+    const float delta_mj = (this->latest_power_ + power_w) / 2 * elapsed_ms;
+
+    this->partial_charge_mc_ += delta_mc;
+    const int64_t charge_int = (int64_t) this->partial_charge_mc_;
+    this->latest_charge_mc_ += charge_int;
+    this->partial_charge_mc_ -= charge_int;
+
+    this->partial_energy_mj_ += delta_mj;
+    const int64_t energy_int = (int64_t) this->partial_energy_mj_;
+    this->latest_energy_mj_ += energy_int;
+    this->partial_energy_mj_ -= energy_int;
+  }
+  this->latest_current_ = current_a;
+  this->latest_power_ = power_w;
+  this->previous_ms_ = now;
+  this->has_previous_ = true;
+  #ifdef USE_COULOMB_METER_STATS
+  this->record_sample_();
+  #endif
+}
+
+}  // namespace coulomb_meter
+}  // namespace esphome
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "coulomb_meter.h"
+
+namespace esphome {
+namespace coulomb_meter {
+
+// Coulomb meter over any current and voltage sensor, for shunt amplifiers on
+// an ADC, Hall sensors or anything else without a dedicated driver. Every new
+// current state is integrated with the trapezoid over the time since the
+// previous one, timed with millis() when the state arrives, so states up to
+// 49.7 days apart are bridged; a rarely publishing source (delta or throttle
+// filters) would wrap 32 bit micros() after 71.6 min. Power is current
+// times the latest voltage, the voltage only changes slowly against the
+// current. NaN states, sensors going unavailable, are not bridged: the
+// interval up to the next valid state is left out.
+class SensorCoulombMeter : public CoulombMeter {
+ public:
+  void setup() override;
+  void dump_config() override;
+  void update() override {}
+
+  void set_current_source(sensor::Sensor *source) { current_source_ = source; }
+  void set_voltage_source(sensor::Sensor *source) { voltage_source_ = source; }
+
+  float get_voltage() override { return latest_voltage_; }
+  float get_current() override { return latest_current_; }
+  int64_t get_charge_c() override { return latest_charge_mc_ / 1000; }
+  int64_t get_energy_j() override { return latest_energy_mj_ / 1000; }
+
+ protected:
+  void on_current_(float current_a);
+
+  sensor::Sensor *current_source_{nullptr};
+  sensor::Sensor *voltage_source_{nullptr};
+
+  float latest_current_{0};
+  float latest_voltage_{0};
+  float latest_power_{0};
+  // the previous current state is valid and taken at previous_ms_
+  bool has_previous_{false};
+  uint32_t previous_ms_{0};
+
+  int64_t latest_charge_mc_{0};
+  int64_t latest_energy_mj_{0};
+  float partial_charge_mc_{0};
+  float partial_energy_mj_{0};
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
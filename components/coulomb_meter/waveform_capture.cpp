@@ -0,0 +1,157 @@
+#include "waveform_capture.h"
+
+#ifdef USE_COULOMB_METER_CAPTURE
+
+#include "esphome/core/log.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+
+namespace esphome {
+namespace coulomb_meter {
+
+static const char *const TAG = "CoulombMeter.capture";
+
+static const uint8_t BLOB_VERSION = 1;
+static const size_t BLOB_HEADER_SIZE = 24;
+static const size_t BLOB_SAMPLE_SIZE = 6;
+// bytes per hex line of dump()
+static const size_t DUMP_LINE_BYTES = 32;
+
+const char *capture_source_to_str(CaptureSource source) {
+  switch (source) {
+    case CAPTURE_SOURCE_CURRENT_ABOVE: return "current above";
+    case CAPTURE_SOURCE_CURRENT_BELOW: return "current below";
+    case CAPTURE_SOURCE_SLOPE: return "dI/dt";
+    case CAPTURE_SOURCE_ACTION: return "action";
+    default: return "none";
+  }
+}
+
+void WaveformCapture::setup(float current_lsb_a, float voltage_lsb_v) {
+  this->current_lsb_a_ = current_lsb_a;
+  this->voltage_lsb_v_ = voltage_lsb_v;
+  if (this->pre_trigger_ >= this->size_) {
+    this->pre_trigger_ = this->size_ - 1;
+  }
+  if (!std::isnan(this->current_above_a_)) {
+    this->current_above_ = lroundf(this->current_above_a_ / current_lsb_a);
+  }
+  if (!std::isnan(this->current_below_a_)) {
+    this->current_below_ = lroundf(this->current_below_a_ / current_lsb_a);
+  }
+  if (this->max_slope_a_s_ > 0) {
+    this->max_slope_ = std::max(1L, lroundf(this->max_slope_a_s_ / current_lsb_a));
+  }
+  this->samples_.reset(new Sample[this->size_]);  // NOLINT(cppcoreguidelines-owning-memory)
+  this->rearm();
+}
+
+void WaveformCapture::rearm() {
+  // samples are ignored while frozen, nothing else writes the ring
+  this->state_.store(CAPTURE_FROZEN);
+  this->head_ = 0;
+  this->count_ = 0;
+  this->has_previous_ = false;
+  this->source_ = CAPTURE_SOURCE_NONE;
+  this->pending_source_.store(CAPTURE_SOURCE_NONE);
+  this->reported_ = false;
+  this->state_.store(CAPTURE_ARMED);
+}
+
+void WaveformCapture::poll() {
+  if (this->reported_ || this->state_.load() != CAPTURE_FROZEN) {
+    return;
+  }
+  this->reported_ = true;
+  ESP_LOGI(TAG, "Captured %u samples, trigger: %s", (unsigned) std::min<uint32_t>(this->count_, this->size_),
+           capture_source_to_str(this->source_));
+  this->capture_trigger_->trigger();
+}
+
+std::vector<uint8_t> WaveformCapture::to_blob() const {
+  std::vector<uint8_t> blob;
+  if (this->state_.load() != CAPTURE_FROZEN || this->samples_ == nullptr) {
+    return blob;
+  }
+  const uint16_t count = std::min<uint32_t>(this->count_, this->size_);
+  // oldest sample, the ring is only partly filled when the trigger came early
+  const uint16_t first = this->count_ > this->size_ ? this->head_ : 0;
+  const uint32_t first_count = this->count_ - count;
+  const uint16_t trigger_index = this->trigger_count_ - first_count;
+
+  blob.resize(BLOB_HEADER_SIZE + count * BLOB_SAMPLE_SIZE);
+  uint8_t *out = blob.data();
+  auto put16 = [&out](uint16_t value) {
+    *out++ = value & 0xFF;
+    *out++ = value >> 8;
+  };
+  auto put32 = [&out](uint32_t value) {
+    for (uint8_t i = 0; i < 4; i++) {
+      *out++ = (value >> (8 * i)) & 0xFF;
+    }
+  };
+  auto put_float = [&put32](float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    put32(bits);
+  };
+
+  memcpy(out, "INAW", 4);
+  out += 4;
+  *out++ = BLOB_VERSION;
+  *out++ = this->source_;
+  put16(count);
+  put16(trigger_index);
+  put16(0);
+  put_float(this->current_lsb_a_);
+  put_float(this->voltage_lsb_v_);
+  put32(this->samples_[first].time_us);
+
+  uint32_t previous_us = this->samples_[first].time_us;
+  for (uint16_t i = 0; i < count; i++) {
+    const Sample &sample = this->samples_[(first + i) % this->size_];
+    const uint32_t elapsed_us = sample.time_us - previous_us;
+    put16(elapsed_us > UINT16_MAX ? UINT16_MAX : elapsed_us);
+    put16(sample.current);
+    put16(sample.voltage);
+    previous_us = sample.time_us;
+  }
+  return blob;
+}
+
+void WaveformCapture::dump() const {
+  const std::vector<uint8_t> blob = this->to_blob();
+  if (blob.empty()) {
+    ESP_LOGW(TAG, "No capture to dump, state: %s",
+             this->state_.load() == CAPTURE_ARMED ? "armed" : "recording post-trigger samples");
+    return;
+  }
+  ESP_LOGI(TAG, "Capture blob, %u bytes:", (unsigned) blob.size());
+  char line[DUMP_LINE_BYTES * 2 + 1];
+  for (size_t offset = 0; offset < blob.size(); offset += DUMP_LINE_BYTES) {
+    const size_t len = std::min(DUMP_LINE_BYTES, blob.size() - offset);
+    for (size_t i = 0; i < len; i++) {
+      snprintf(line + 2 * i, 3, "%02x", blob[offset + i]);
+    }
+    ESP_LOGI(TAG, "%04x: %s", (unsigned) offset, line);
+  }
+}
+
+void WaveformCapture::dump_config(const char *tag) const {
+  ESP_LOGCONFIG(tag, "  Capture: %u samples, %u before the trigger", this->size_, this->pre_trigger_);
+  if (this->current_above_ != INT32_MAX) {
+    ESP_LOGCONFIG(tag, "    Current above: %.3f A", this->current_above_a_);
+  }
+  if (this->current_below_ != INT32_MIN) {
+    ESP_LOGCONFIG(tag, "    Current below: %.3f A", this->current_below_a_);
+  }
+  if (this->max_slope_ != 0) {
+    ESP_LOGCONFIG(tag, "    Max dI/dt: %.1f A/s", this->max_slope_a_s_);
+  }
+}
+
+}  // namespace coulomb_meter
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,190 @@
+#pragma once
+
+#ifdef USE_COULOMB_METER_CAPTURE
+
+#include "esphome/core/automation.h"
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace esphome {
+namespace coulomb_meter {
+
+enum CaptureSource : uint8_t {
+  CAPTURE_SOURCE_NONE,
+  CAPTURE_SOURCE_CURRENT_ABOVE,
+  CAPTURE_SOURCE_CURRENT_BELOW,
+  CAPTURE_SOURCE_SLOPE,
+  CAPTURE_SOURCE_ACTION,
+};
+
+enum CaptureState : uint8_t {
+  // recording pre-trigger samples, waiting for a trigger
+  CAPTURE_ARMED,
+  // recording post-trigger samples
+  CAPTURE_TRIGGERED,
+  // the ring holds a complete capture, samples are ignored until rearm()
+  CAPTURE_FROZEN,
+};
+
+const char *capture_source_to_str(CaptureSource source);
+
+// Pre/post-trigger ring of raw INA samples at the full sample rate. The ring
+// is allocated once in setup(); add() does not allocate, takes no locks and
+// uses integer math only, so drivers may call it from calc_charge() or the
+// I2C interrupt. Triggers: a threshold crossing of the current, a dI/dt
+// limit between two samples, or trigger() from an automation.
+//
+// to_blob() layout, little-endian:
+//   0  char[4]  "INAW"
+//   4  uint8    version (1)
+//   5  uint8    CaptureSource of the trigger
+//   6  uint16   sample count
+//   8  uint16   index of the trigger sample
+//   10 uint16   reserved
+//   12 float    A per raw current step
+//   16 float    V per raw bus voltage step
+//   20 uint32   micros() of the first sample
+//   24 samples, 6 bytes each: uint16 µs since the previous sample
+//      (saturated), int16 raw current, int16 raw bus voltage
+class WaveformCapture {
+ public:
+  void set_size(uint16_t size) { this->size_ = size; }
+  void set_pre_trigger(uint16_t pre_trigger) { this->pre_trigger_ = pre_trigger; }
+  void set_current_above(float current_a) { this->current_above_a_ = current_a; }
+  void set_current_below(float current_a) { this->current_below_a_ = current_a; }
+  void set_max_slope(float amperes_per_second) { this->max_slope_a_s_ = amperes_per_second; }
+
+  // allocates the ring and converts the triggers to raw steps, called by the
+  // driver's setup() once its calibration is known
+  void setup(float current_lsb_a, float voltage_lsb_v);
+
+  void add(uint32_t time_us, int16_t current, int16_t voltage) {
+    if (this->state_.load() == CAPTURE_FROZEN) {
+      return;
+    }
+    if (this->state_.load() == CAPTURE_ARMED && this->has_previous_) {
+      CaptureSource source = this->pending_source_.load();
+      if (source == CAPTURE_SOURCE_NONE) {
+        source = this->check_triggers_(time_us, current);
+      }
+      if (source != CAPTURE_SOURCE_NONE) {
+        this->source_ = source;
+        this->pending_source_.store(CAPTURE_SOURCE_NONE);
+        this->trigger_count_ = this->count_;
+        this->post_remaining_ = this->size_ - this->pre_trigger_;
+        this->state_.store(CAPTURE_TRIGGERED);
+      }
+    }
+    Sample &sample = this->samples_[this->head_];
+    sample.time_us = time_us;
+    sample.current = current;
+    sample.voltage = voltage;
+    this->head_ = this->head_ + 1 == this->size_ ? 0 : this->head_ + 1;
+    this->count_++;
+    this->previous_time_us_ = time_us;
+    this->previous_current_ = current;
+    this->has_previous_ = true;
+
+    if (this->state_.load() == CAPTURE_TRIGGERED && --this->post_remaining_ == 0) {
+      this->state_.store(CAPTURE_FROZEN);
+    }
+  }
+
+  // triggers with the next sample, for automations
+  void trigger() { this->pending_source_.store(CAPTURE_SOURCE_ACTION); }
+  // drops the frozen capture and records again
+  void rearm();
+
+  // fires the capture trigger once a capture froze, called from the loop
+  void poll();
+
+  CaptureState get_state() const { return this->state_.load(); }
+  CaptureSource get_source() const { return this->source_; }
+  // the frozen capture in the layout above, empty unless frozen
+  std::vector<uint8_t> to_blob() const;
+  // logs the blob as hex lines, for copying from the log
+  void dump() const;
+  void dump_config(const char *tag) const;
+
+  Trigger<> *get_capture_trigger() const { return this->capture_trigger_; }
+
+ protected:
+  struct Sample {
+    uint32_t time_us;
+    int16_t current;
+    int16_t voltage;
+  };
+
+  CaptureSource check_triggers_(uint32_t time_us, int16_t current) const {
+    if (this->current_above_ != INT32_MAX && this->previous_current_ <= this->current_above_ &&
+        current > this->current_above_) {
+      return CAPTURE_SOURCE_CURRENT_ABOVE;
+    }
+    if (this->current_below_ != INT32_MIN && this->previous_current_ >= this->current_below_ &&
+        current < this->current_below_) {
+      return CAPTURE_SOURCE_CURRENT_BELOW;
+    }
+    if (this->max_slope_ != 0) {
+      // |dI| / dt > limit, as |dI| * 1e6 > limit * dt_us in raw steps per second
+      const int64_t step = int32_t(current) - this->previous_current_;
+      const int64_t elapsed_us = time_us - this->previous_time_us_;
+      if ((step < 0 ? -step : step) * 1000000 > int64_t(this->max_slope_) * elapsed_us) {
+        return CAPTURE_SOURCE_SLOPE;
+      }
+    }
+    return CAPTURE_SOURCE_NONE;
+  }
+
+  uint16_t size_{512};
+  uint16_t pre_trigger_{128};
+  float current_above_a_{NAN};
+  float current_below_a_{NAN};
+  float max_slope_a_s_{0};
+  float current_lsb_a_{0};
+  float voltage_lsb_v_{0};
+
+  // triggers in raw steps, INT32_MAX/MIN and 0 when unset
+  int32_t current_above_{INT32_MAX};
+  int32_t current_below_{INT32_MIN};
+  uint32_t max_slope_{0};
+
+  std::unique_ptr<Sample[]> samples_;
+  uint16_t head_{0};
+  // samples since the last rearm
+  uint32_t count_{0};
+  uint32_t trigger_count_{0};
+  uint16_t post_remaining_{0};
+  uint32_t previous_time_us_{0};
+  int16_t previous_current_{0};
+  bool has_previous_{false};
+
+  std::atomic<CaptureState> state_{CAPTURE_ARMED};
+  std::atomic<CaptureSource> pending_source_{CAPTURE_SOURCE_NONE};
+  CaptureSource source_{CAPTURE_SOURCE_NONE};
+  // the loop saw the frozen capture and fired the trigger
+  bool reported_{false};
+  Trigger<> *capture_trigger_ = new Trigger<>();
+};
+
+template<typename... Ts> class CaptureTriggerAction : public Action<Ts...>, public Parented<WaveformCapture> {
+ public:
+  void play(Ts... x) override { this->parent_->trigger(); }
+};
+
+template<typename... Ts> class CaptureRearmAction : public Action<Ts...>, public Parented<WaveformCapture> {
+ public:
+  void play(Ts... x) override { this->parent_->rearm(); }
+};
+
+template<typename... Ts> class CaptureDumpAction : public Action<Ts...>, public Parented<WaveformCapture> {
+ public:
+  void play(Ts... x) override { this->parent_->dump(); }
+};
+
+}  // namespace coulomb_meter
+}  // namespace esphome
+
+#endif
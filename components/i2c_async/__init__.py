@@ -0,0 +1,70 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+import esphome.final_validate as fv
+from esphome import pins
+from esphome.components import i2c
+from esphome.const import (
+    CONF_FREQUENCY,
+    CONF_ID,
+    CONF_SCL,
+    CONF_SDA,
+    CONF_TIMEOUT,
+)
+
+CODEOWNERS = ["SqrTT"]
+
+CONF_PULLUP_ENABLED = "pullup_enabled"
+CONF_ASYNC_READS = "async_reads"
+
+DOMAIN = "i2c_async"
+
+i2c_async_ns = cg.esphome_ns.namespace("i2c_async")
+I2CAsyncBus = i2c_async_ns.class_("I2CAsyncBus", i2c.I2CBus, cg.Component)
+
+# a separate bus on ESP-IDF's i2c_master driver, INA platforms take it as i2c_id
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(I2CAsyncBus),
+            cv.Required(CONF_SDA): pins.internal_gpio_output_pin_number,
+            cv.Required(CONF_SCL): pins.internal_gpio_output_pin_number,
+            cv.Optional(CONF_PULLUP_ENABLED, default=True): cv.boolean,
+            cv.Optional(CONF_FREQUENCY, default="400kHz"): cv.All(
+                cv.frequency, cv.Range(min=0, min_included=False, max=1e6)
+            ),
+            # for the blocking reads and writes, background reads never wait
+            cv.Optional(CONF_TIMEOUT, default="10ms"): cv.positive_time_period_milliseconds,
+        }
+    ).extend(cv.COMPONENT_SCHEMA),
+    cv.only_with_esp_idf,
+)
+
+
+async def to_code(config):
+    cg.add_define("USE_I2C_ASYNC")
+    bus = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(bus, config)
+    cg.add(bus.set_sda_pin(config[CONF_SDA]))
+    cg.add(bus.set_scl_pin(config[CONF_SCL]))
+    cg.add(bus.set_pullup_enabled(config[CONF_PULLUP_ENABLED]))
+    cg.add(bus.set_frequency(int(config[CONF_FREQUENCY])))
+    cg.add(bus.set_timeout(config[CONF_TIMEOUT]))
+
+
+def validate_async_reads(config):
+    """Final validation for devices with async_reads, they need an i2c_async bus as i2c_id."""
+    if not config.get(CONF_ASYNC_READS):
+        return config
+    path = fv.full_config.get().get_path_for_id(config[i2c.CONF_I2C_ID])
+    if not path or path[0] != DOMAIN:
+        raise cv.Invalid(
+            f"{CONF_ASYNC_READS} needs an {DOMAIN} bus, '{config[i2c.CONF_I2C_ID]}' is not one",
+            path=[i2c.CONF_I2C_ID],
+        )
+    return config
+
+
+async def setup_async_reads(var, config):
+    if config.get(CONF_ASYNC_READS):
+        bus = await cg.get_variable(config[i2c.CONF_I2C_ID])
+        cg.add(var.set_async_bus(bus))
@@ -0,0 +1,246 @@
+#include "i2c_async.h"
+
+#ifdef USE_ESP_IDF
+
+#include "esphome/core/log.h"
+#include <esp_timer.h>
+#include <cinttypes>
+#include <cstring>
+
+namespace esphome {
+namespace i2c_async {
+
+static const char *const TAG = "i2c_async";
+
+// every reader can fill its queue, plus the blocking transaction
+static const uint32_t TRANS_QUEUE_DEPTH = AsyncRegisterReader::QUEUE_SIZE * 2;
+
+bool AsyncRegisterReader::read_register16(uint8_t a_register) {
+  const uint8_t queued = this->queued_.load();
+  if ((uint8_t) (queued - this->completed_.load()) >= QUEUE_SIZE) {
+    return false;
+  }
+  Slot &slot = this->slots_[queued % QUEUE_SIZE];
+  slot.a_register = a_register;
+  // counted before the call, the read may complete before it returns
+  this->queued_.store(queued + 1);
+  // in asynchronous mode the driver only queues the transaction, a timeout of 0
+  // fails instead of waiting when its queue is full
+  if (i2c_master_transmit_receive(this->handle_, &slot.a_register, 1, slot.data, sizeof(slot.data), 0) != ESP_OK) {
+    this->queued_.store(queued);
+    this->errors_++;
+    return false;
+  }
+  return true;
+}
+
+void IRAM_ATTR AsyncRegisterReader::on_done_(const i2c_master_event_data_t *event) {
+  const uint8_t completed = this->completed_.load();
+  const Slot &slot = this->slots_[completed % QUEUE_SIZE];
+  if (event->event == I2C_EVENT_DONE) {
+    this->callback_(this->callback_arg_, slot.a_register, (uint16_t(slot.data[0]) << 8) | slot.data[1],
+                    esp_timer_get_time());
+  } else {
+    this->errors_++;
+  }
+  this->completed_.store(completed + 1);
+}
+
+void I2CAsyncBus::setup() {
+  i2c_master_bus_config_t config{};
+  // any free port, ESPHome's i2c component may hold the others
+  config.i2c_port = -1;
+  config.sda_io_num = (gpio_num_t) this->sda_pin_;
+  config.scl_io_num = (gpio_num_t) this->scl_pin_;
+  config.clk_source = I2C_CLK_SRC_DEFAULT;
+  config.glitch_ignore_cnt = 7;
+  // a transaction queue puts the driver in asynchronous mode
+  config.trans_queue_depth = TRANS_QUEUE_DEPTH;
+  config.flags.enable_internal_pullup = this->pullup_enabled_;
+
+  const esp_err_t err = i2c_new_master_bus(&config, &this->bus_);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "Creating the bus failed: %s", esp_err_to_name(err));
+    this->bus_ = nullptr;
+    this->mark_failed();
+  }
+}
+
+void I2CAsyncBus::dump_config() {
+  ESP_LOGCONFIG(TAG, "Async I2C Bus:");
+  ESP_LOGCONFIG(TAG, "  SDA Pin: GPIO%u", this->sda_pin_);
+  ESP_LOGCONFIG(TAG, "  SCL Pin: GPIO%u", this->scl_pin_);
+  ESP_LOGCONFIG(TAG, "  Frequency: %" PRIu32 " Hz", this->frequency_);
+  ESP_LOGCONFIG(TAG, "  Timeout: %" PRIu32 " ms", this->timeout_ms_);
+  if (this->is_failed()) {
+    ESP_LOGE(TAG, "  Setting up the bus failed!");
+    return;
+  }
+  for (auto *device : this->devices_) {
+    if (device->reader != nullptr) {
+      ESP_LOGCONFIG(TAG, "  0x%02X: background reads, %" PRIu32 " failed", device->address,
+                    device->reader->get_errors());
+    }
+  }
+}
+
+bool IRAM_ATTR I2CAsyncBus::on_trans_done_(i2c_master_dev_handle_t handle, const i2c_master_event_data_t *event,
+                                           void *arg) {
+  auto *device = static_cast<Device *>(arg);
+  if (device->bus->sync_active_.load()) {
+    device->bus->sync_event_.store(event->event);
+  } else if (device->reader != nullptr) {
+    device->reader->on_done_(event);
+  }
+  // no task was woken
+  return false;
+}
+
+I2CAsyncBus::Device *I2CAsyncBus::get_device_(uint8_t address) {
+  for (auto *device : this->devices_) {
+    if (device->address == address) {
+      return device;
+    }
+  }
+  if (this->bus_ == nullptr) {
+    return nullptr;
+  }
+
+  i2c_device_config_t config{};
+  config.dev_addr_length = I2C_ADDR_BIT_LEN_7;
+  config.device_address = address;
+  config.scl_speed_hz = this->frequency_;
+  i2c_master_dev_handle_t handle;
+  esp_err_t err = i2c_master_bus_add_device(this->bus_, &config, &handle);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "0x%02X: adding the device failed: %s", address, esp_err_to_name(err));
+    return nullptr;
+  }
+  auto *device = new Device{address, handle, nullptr, this};  // NOLINT(cppcoreguidelines-owning-memory)
+  // one handle per address, blocking and background transactions share its callback
+  i2c_master_event_callbacks_t callbacks{};
+  callbacks.on_trans_done = I2CAsyncBus::on_trans_done_;
+  err = i2c_master_register_event_callbacks(handle, &callbacks, device);
+  if (err != ESP_OK) {
+    ESP_LOGE(TAG, "0x%02X: registering the callback failed: %s", address, esp_err_to_name(err));
+    i2c_master_bus_rm_device(handle);
+    delete device;  // NOLINT(cppcoreguidelines-owning-memory)
+    return nullptr;
+  }
+  this->devices_.push_back(device);
+  return device;
+}
+
+AsyncRegisterReader *I2CAsyncBus::add_reader(uint8_t address, ReadCallback callback, void *arg) {
+  Device *device = this->get_device_(address);
+  if (device == nullptr) {
+    return nullptr;
+  }
+  if (device->reader == nullptr) {
+    device->reader = new AsyncRegisterReader();  // NOLINT(cppcoreguidelines-owning-memory)
+  }
+  device->reader->callback_ = callback;
+  device->reader->callback_arg_ = arg;
+  device->reader->handle_ = device->handle;
+  return device->reader;
+}
+
+bool I2CAsyncBus::begin_sync_() {
+  // background reads are only queued from the loop, none start while this one runs
+  if (i2c_master_bus_wait_all_done(this->bus_, this->timeout_ms_) != ESP_OK) {
+    return false;
+  }
+  this->sync_event_.store(-1);
+  this->sync_active_.store(true);
+  return true;
+}
+
+i2c::ErrorCode I2CAsyncBus::wait_sync_(esp_err_t err) {
+  if (err == ESP_OK) {
+    err = i2c_master_bus_wait_all_done(this->bus_, this->timeout_ms_);
+  }
+  this->sync_active_.store(false);
+  if (err == ESP_ERR_TIMEOUT) {
+    return i2c::ERROR_TIMEOUT;
+  }
+  if (err != ESP_OK) {
+    return i2c::ERROR_UNKNOWN;
+  }
+  switch (this->sync_event_.load()) {
+    case I2C_EVENT_DONE:
+      return i2c::ERROR_OK;
+    case I2C_EVENT_NACK:
+      return i2c::ERROR_NOT_ACKNOWLEDGED;
+    default:
+      return i2c::ERROR_UNKNOWN;
+  }
+}
+
+i2c::ErrorCode I2CAsyncBus::readv(uint8_t address, i2c::ReadBuffer *buffers, size_t cnt) {
+  Device *device = this->get_device_(address);
+  if (device == nullptr) {
+    return i2c::ERROR_NOT_INITIALIZED;
+  }
+  size_t len = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    len += buffers[i].len;
+  }
+  if (len == 0) {
+    return i2c::ERROR_INVALID_ARGUMENT;
+  }
+  this->buffer_.resize(len);
+  if (!this->begin_sync_()) {
+    return i2c::ERROR_TIMEOUT;
+  }
+  const i2c::ErrorCode result =
+      this->wait_sync_(i2c_master_receive(device->handle, this->buffer_.data(), len, this->timeout_ms_));
+  if (result != i2c::ERROR_OK) {
+    return result;
+  }
+  size_t pos = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    memcpy(buffers[i].data, this->buffer_.data() + pos, buffers[i].len);
+    pos += buffers[i].len;
+  }
+  return i2c::ERROR_OK;
+}
+
+i2c::ErrorCode I2CAsyncBus::writev(uint8_t address, i2c::WriteBuffer *buffers, size_t cnt, bool stop) {
+  if (this->bus_ == nullptr) {
+    return i2c::ERROR_NOT_INITIALIZED;
+  }
+  size_t len = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    len += buffers[i].len;
+  }
+  if (len == 0) {
+    // address probe
+    if (i2c_master_bus_wait_all_done(this->bus_, this->timeout_ms_) != ESP_OK) {
+      return i2c::ERROR_TIMEOUT;
+    }
+    const esp_err_t err = i2c_master_probe(this->bus_, address, this->timeout_ms_);
+    if (err == ESP_ERR_NOT_FOUND) {
+      return i2c::ERROR_NOT_ACKNOWLEDGED;
+    }
+    return err == ESP_OK ? i2c::ERROR_OK : i2c::ERROR_TIMEOUT;
+  }
+  Device *device = this->get_device_(address);
+  if (device == nullptr) {
+    return i2c::ERROR_NOT_INITIALIZED;
+  }
+  this->buffer_.clear();
+  for (size_t i = 0; i < cnt; i++) {
+    this->buffer_.insert(this->buffer_.end(), buffers[i].data, buffers[i].data + buffers[i].len);
+  }
+  // every transaction ends with a stop; register pointer writes without one
+  // (stop == false) are kept by INA and most register devices anyway
+  if (!this->begin_sync_()) {
+    return i2c::ERROR_TIMEOUT;
+  }
+  return this->wait_sync_(i2c_master_transmit(device->handle, this->buffer_.data(), len, this->timeout_ms_));
+}
+
+}  // namespace i2c_async
+}  // namespace esphome
+
+#endif
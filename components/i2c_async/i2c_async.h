@@ -0,0 +1,111 @@
+#pragma once
+
+#ifdef USE_ESP_IDF
+
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/components/i2c/i2c_bus.h"
+#include <driver/i2c_master.h>
+#include <atomic>
+#include <vector>
+
+namespace esphome {
+namespace i2c_async {
+
+// Completion of a background register read. Runs in the I2C interrupt: no
+// logging, no blocking and no floats, the ESP32 does not save the FPU
+// registers for interrupt handlers. time_us is esp_timer time at completion.
+using ReadCallback = void (*)(void *arg, uint8_t a_register, uint16_t value, int64_t time_us);
+
+class I2CAsyncBus;
+
+// Background reads of 16 bit registers of one device. Reads complete in the
+// order they were queued, the callback gets the register and its value.
+class AsyncRegisterReader {
+ public:
+  static const uint8_t QUEUE_SIZE = 4;
+
+  // queues a read of the big-endian register, false when QUEUE_SIZE reads are
+  // pending or the driver refused it; never waits for the bus
+  bool read_register16(uint8_t a_register);
+  uint8_t get_pending() const { return this->queued_.load() - this->completed_.load(); }
+  // NACKed or timed out reads, their callback is not called
+  uint32_t get_errors() const { return this->errors_.load(); }
+
+ protected:
+  friend class I2CAsyncBus;
+
+  void on_done_(const i2c_master_event_data_t *event);
+
+  struct Slot {
+    uint8_t a_register;
+    uint8_t data[2];
+  };
+
+  ReadCallback callback_{nullptr};
+  void *callback_arg_{nullptr};
+  i2c_master_dev_handle_t handle_{nullptr};
+  // the driver keeps pointers into a slot until its read completed
+  Slot slots_[QUEUE_SIZE];
+  // queued_ is advanced by read_register16(), completed_ by the interrupt
+  std::atomic<uint8_t> queued_{0};
+  std::atomic<uint8_t> completed_{0};
+  std::atomic<uint32_t> errors_{0};
+};
+
+// I2C bus on ESP-IDF's i2c_master driver in asynchronous mode. The regular
+// I2CBus reads and writes wait for the transaction, so devices set up and
+// poll as usual; AsyncRegisterReader reads run in the background and
+// complete in the interrupt. The bus is not shared with ESPHome's i2c
+// component, devices that read in the background should be alone on it.
+class I2CAsyncBus : public i2c::I2CBus, public Component {
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::BUS; }
+
+  void set_sda_pin(uint8_t sda_pin) { this->sda_pin_ = sda_pin; }
+  void set_scl_pin(uint8_t scl_pin) { this->scl_pin_ = scl_pin; }
+  void set_pullup_enabled(bool pullup_enabled) { this->pullup_enabled_ = pullup_enabled; }
+  void set_frequency(uint32_t frequency) { this->frequency_ = frequency; }
+  void set_timeout(uint32_t timeout_ms) { this->timeout_ms_ = timeout_ms; }
+
+  // background reads for the device at address, nullptr when the bus failed
+  AsyncRegisterReader *add_reader(uint8_t address, ReadCallback callback, void *arg);
+
+  i2c::ErrorCode readv(uint8_t address, i2c::ReadBuffer *buffers, size_t cnt) override;
+  i2c::ErrorCode writev(uint8_t address, i2c::WriteBuffer *buffers, size_t cnt, bool stop) override;
+
+ protected:
+  struct Device {
+    uint8_t address;
+    i2c_master_dev_handle_t handle;
+    AsyncRegisterReader *reader;
+    I2CAsyncBus *bus;
+  };
+
+  static bool on_trans_done_(i2c_master_dev_handle_t handle, const i2c_master_event_data_t *event, void *arg);
+  Device *get_device_(uint8_t address);
+  // blocking I2CBus calls: wait for the background reads, queue the
+  // transaction, then wait for its completion
+  bool begin_sync_();
+  i2c::ErrorCode wait_sync_(esp_err_t err);
+
+  uint8_t sda_pin_;
+  uint8_t scl_pin_;
+  bool pullup_enabled_{true};
+  uint32_t frequency_{400000};
+  uint32_t timeout_ms_{10};
+
+  i2c_master_bus_handle_t bus_{nullptr};
+  std::vector<Device *> devices_;
+  std::vector<uint8_t> buffer_;
+  // set while a blocking call runs, its completion goes to sync_event_
+  std::atomic<bool> sync_active_{false};
+  std::atomic<int> sync_event_{-1};
+};
+
+}  // namespace i2c_async
+}  // namespace esphome
+
+#endif
@@ -1,11 +1,12 @@
 #include "ina219_coulomb.h"
 #include "esphome/core/log.h"
 #include "esphome/core/hal.h"
+#include <cinttypes>
 
 namespace esphome {
 namespace ina219_coulomb {
 
-static const char *const TAG = "ina219_coulomb";
+static const char *const TAG = INA219Traits::TAG;
 
 // | A0   | A1   | Address |
 // | GND  | GND  | 0x40    |
@@ -26,11 +27,9 @@ static const char *const TAG = "ina219_coulomb";
 // | SCL  | SCL  | 0x4F    |
 
 static const uint8_t INA219_READ = 0x01;
+// shunt voltage, bus voltage and current registers are in INA219Traits
 static const uint8_t INA219_REGISTER_CONFIG = 0x00;
-static const uint8_t INA219_REGISTER_SHUNT_VOLTAGE = 0x01;
-static const uint8_t INA219_REGISTER_BUS_VOLTAGE = 0x02;
 static const uint8_t INA219_REGISTER_POWER = 0x03;
-static const uint8_t INA219_REGISTER_CURRENT = 0x04;
 static const uint8_t INA219_REGISTER_CALIBRATION = 0x05;
 
 void INA219Component::setup() {
@@ -126,16 +125,8 @@ void INA219Component::setup() {
     return;
   }
 
-  this->CoulombMeter::setup();
-
-  this->disable_loop();
-
-  this->set_interval("calcCharge", 1, [this]() {
-    this->calc_charge();
-  });
-
-  this->previous_time_ = App.get_loop_component_start_time();
-  this->charge_read_time_ = App.get_loop_component_start_time();
+  this->current_lsb_a_ = this->calibration_lsb_ / 1000000.0f;
+  this->setup_core_();
 }
 
 void INA219Component::on_powerdown() {
@@ -153,104 +144,7 @@ void INA219Component::dump_config() {
     ESP_LOGE(TAG, ESP_LOG_MSG_COMM_FAIL);
     return;
   }
-  LOG_UPDATE_INTERVAL(this);
-
-  LOG_SENSOR("  ", "Bus Voltage", this->bus_voltage_sensor_);
-  LOG_SENSOR("  ", "Shunt Voltage", this->shunt_voltage_sensor_);
-  LOG_SENSOR("  ", "Current", this->current_sensor_);
-  LOG_SENSOR("  ", "Power", this->power_sensor_);
-}
-
-float INA219Component::get_setup_priority() const { return setup_priority::DATA; }
-
-void INA219Component::calc_charge() {
-  const auto now = App.get_loop_component_start_time();
-
-  if (now == this->previous_time_) {
-    // skip if called too fast (less than 1ms)
-    return;
-  }
-  if (reads_count_ == 1) {
-    uint16_t raw_bus_voltage;
-    if (!this->read_byte_16(INA219_REGISTER_BUS_VOLTAGE, &raw_bus_voltage)) {
-      this->status_set_warning("Failed to read bus voltage");
-      return;
-    }
-    raw_bus_voltage >>= 3;
-    const float bus_voltage_v = int16_t(raw_bus_voltage) * 0.004f;
-   
-    this->latest_voltage_ = bus_voltage_v;
-  } else if (reads_count_ >= 20) {
-    reads_count_ = 0;
-  };
-  reads_count_++;
-
-  uint16_t raw_current;
-  if (!this->read_byte_16(INA219_REGISTER_CURRENT, &raw_current)) {
-    this->status_set_warning("Failed to read current");
-    return;
-  }
-  const auto current_a  = int16_t(raw_current) * (this->calibration_lsb_ / 1000.0f) / 1000.0f;
-
-  this->latest_current_ = current_a;
-  const auto delta_mc = current_a * (now - this->previous_time_);
-
-  this->partial_charge_mc_ += delta_mc; 
-  
-  const int64_t delta_int = (int64_t)this->partial_charge_mc_;
-  this->latest_charge_mc_ += delta_int;
-  this->partial_charge_mc_ -= delta_int;
-  
-  this->partial_energy_mj_ += this->latest_voltage_.value_or(0) * delta_mc; 
-  const int64_t energy_int = (int64_t)this->partial_energy_mj_;
-  this->latest_energy_mj_ += energy_int;
-  this->partial_energy_mj_ -= energy_int;
-
-  this->previous_time_ = now;
-
-  this->charge_reads_count_++;
-}
-
-void INA219Component::update() {
-  if (this->bus_voltage_sensor_ != nullptr) {
-    this->bus_voltage_sensor_->publish_state(this->latest_voltage_.value_or(NAN));
-  }
-
-  if (this->shunt_voltage_sensor_ != nullptr) {
-    uint16_t raw_shunt_voltage;
-    if (!this->read_byte_16(INA219_REGISTER_SHUNT_VOLTAGE, &raw_shunt_voltage)) {
-      this->status_set_warning("Failed to read shunt voltage");
-      return;
-    }
-    float shunt_voltage_mv = int16_t(raw_shunt_voltage) * 0.01f;
-    this->shunt_voltage_sensor_->publish_state(shunt_voltage_mv / 1000.0f);
-  }
-
-  if (this->current_sensor_ != nullptr) {
-    this->current_sensor_->publish_state(this->latest_current_);
-  }
-
-  if (this->power_sensor_ != nullptr) {
-    this->power_sensor_->publish_state(this->latest_voltage_.value_or(0) * this->latest_current_);
-  }
-
-  if (this->charge_coulombs_sensor_ != nullptr) {
-    this->charge_coulombs_sensor_->publish_state(this->get_charge_c());
-  }
-
-  if (this->read_per_second_sensor_ != nullptr) {
-    auto const now = App.get_loop_component_start_time();
-    auto const elapsed_s = (now - this->charge_read_time_) / 1000.0f;
-    if (elapsed_s != 0) {
-      const auto reads_per_second = static_cast<float>(this->charge_reads_count_) / elapsed_s;
-      this->read_per_second_sensor_->publish_state(reads_per_second);
-    }
-    // Reset charge_reads_count_ and update charge_read_time_ to start a new measurement interval for reads-per-second calculation.
-    this->charge_reads_count_ = 0;
-    this->charge_read_time_ = now;
-  }
-
-  this->status_clear_warning();
+  this->dump_core_config_();
 }
 
 }  // namespace ina219
@@ -20,7 +20,20 @@ from esphome.const import (
     UNIT_HERTZ,
     ENTITY_CATEGORY_DIAGNOSTIC
 )
-from ..coulomb_meter import (COULOMB_SCHEMA, setup_coulomb, CoulombMeter_ns)
+from ..coulomb_meter import (
+    CAPTURE_PLATFORM_SCHEMA,
+    COULOMB_SCHEMA,
+    GAP_SCHEMA,
+    SAMPLE_STATS_SCHEMA,
+    STREAM_PLATFORM_SCHEMA,
+    CoulombMeter_ns,
+    setup_capture,
+    setup_coulomb,
+    setup_gap_detection,
+    setup_sample_stats,
+    setup_stream,
+)
+from ..i2c_async import CONF_ASYNC_READS, setup_async_reads, validate_async_reads
 AUTO_LOAD = ["coulomb_meter"]
 DEPENDENCIES = ["i2c"]
 CONF_READ_PER_SECOND = "read_per_second"
@@ -79,15 +92,23 @@ CONFIG_SCHEMA = (
                 accuracy_decimals=0,
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
-            
+            # needs an i2c_async bus as i2c_id, calc_charge() then never waits for the bus
+            cv.Optional(CONF_ASYNC_READS, default=False): cv.boolean,
         }
     )
     .extend(cv.polling_component_schema("60s"))
     .extend(i2c.i2c_device_schema(0x40))
     .extend(COULOMB_SCHEMA) 
+    .extend(SAMPLE_STATS_SCHEMA)
+    .extend(GAP_SCHEMA)
+    .extend(CAPTURE_PLATFORM_SCHEMA)
+    .extend(STREAM_PLATFORM_SCHEMA)
 )
 
 
+FINAL_VALIDATE_SCHEMA = validate_async_reads
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
     await cg.register_component(var, config)
@@ -121,4 +142,9 @@ async def to_code(config):
         sens = await sensor.new_sensor(conf)
         cg.add(var.set_charge_coulombs_sensor(sens))
 
+    await setup_sample_stats(var, config)
+    await setup_gap_detection(var, config)
+    await setup_capture(var, config)
+    await setup_stream(var, config)
+    await setup_async_reads(var, config)
     await setup_coulomb(var, config)
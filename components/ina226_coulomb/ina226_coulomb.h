@@ -1,11 +1,7 @@
 #pragma once
 
 // originaly by ["@Sergio303", "@latonita"] - https://github.com/esphome/esphome/tree/dev/esphome/components/ina226
-#include "esphome/core/component.h"
-#include "esphome/components/sensor/sensor.h"
-#include "esphome/components/i2c/i2c.h"
-#include "../coulomb_meter/coulomb_meter.h"
-
+#include "../coulomb_meter/ina_coulomb_core.h"
 
 namespace esphome {
 namespace ina226_coulomb {
@@ -44,17 +40,25 @@ union ConfigurationRegister {
   } __attribute__((packed));
 };
 
-class INA226Component : public i2c::I2CDevice, public coulomb_meter::CoulombMeter  {
+// Current register 0x04 with the calibration LSB, bus voltage in 1.25 mV steps,
+// shunt voltage in 2.5 µV steps, all 16 bit two's complement without shifts.
+struct INA226Traits {
+  static constexpr const char *TAG = "ina226_coulomb";
+  static constexpr uint8_t REGISTER_SHUNT_VOLTAGE = 0x01;
+  static constexpr uint8_t REGISTER_BUS_VOLTAGE = 0x02;
+  static constexpr uint8_t REGISTER_CURRENT = 0x04;
+  static constexpr uint8_t CURRENT_SHIFT = 0;
+  static constexpr uint8_t BUS_VOLTAGE_SHIFT = 0;
+  static constexpr uint8_t SHUNT_VOLTAGE_SHIFT = 0;
+  static constexpr float BUS_VOLTAGE_LSB = 0.00125f;
+  static constexpr float SHUNT_VOLTAGE_LSB = 0.0000025f;
+};
+
+class INA226Component : public coulomb_meter::InaCoulombCore<INA226Traits> {
  public:
   void setup() override;
   void dump_config() override;
-  void update() override;
-  float get_setup_priority() const override;
-  void report_coulomb();
-  void calc_charge();
 
-  void set_shunt_resistance_ohm(float shunt_resistance_ohm) { shunt_resistance_ohm_ = shunt_resistance_ohm; }
-  void set_max_current_a(float max_current_a) { max_current_a_ = max_current_a; }
   void set_adc_time_voltage(AdcTime time) { adc_time_voltage_ = time; }
   void set_adc_time_current(AdcTime time) { adc_time_current_ = time; }
   void set_adc_avg_samples(AdcAvgSamples samples) { adc_avg_samples_ = samples; }
@@ -63,51 +67,10 @@ class INA226Component : public i2c::I2CDevice, public coulomb_meter::CoulombMete
      high_frequency_loop_requester.start();
   };
 
-  void set_bus_voltage_sensor(sensor::Sensor *bus_voltage_sensor) { bus_voltage_sensor_ = bus_voltage_sensor; }
-  void set_bus_voltage_calibration(float calibration) { bus_voltage_calibration_ = calibration; }
-  void set_shunt_voltage_sensor(sensor::Sensor *shunt_voltage_sensor) { shunt_voltage_sensor_ = shunt_voltage_sensor; }
-  void set_current_sensor(sensor::Sensor *current_sensor) { current_sensor_ = current_sensor; }
-  void set_power_sensor(sensor::Sensor *power_sensor) { power_sensor_ = power_sensor; }
-  void set_charge_coulombs_sensor(sensor::Sensor *power_sensor) { charge_coulombs_sensor_ = power_sensor; }
-  void set_read_per_second_sensor(sensor::Sensor *read_per_second_sensor) { read_per_second_sensor_ = read_per_second_sensor; }
-
-  float get_voltage() override { return latest_voltage_.value_or(0);  };
-  float get_current() override { return latest_current_;  };
-  int64_t get_charge_c() override { return latest_charge_mc_ / 1000; } ;
-  int64_t get_energy_j() override { return latest_energy_mj_ / 1000; } ;
-
  protected:
-  int64_t latest_energy_mj_{0};
-  int64_t latest_charge_mc_{0};
-  float shunt_resistance_ohm_;
-  float max_current_a_;
   AdcTime adc_time_voltage_{AdcTime::ADC_TIME_1100US};
   AdcTime adc_time_current_{AdcTime::ADC_TIME_1100US};
   AdcAvgSamples adc_avg_samples_{AdcAvgSamples::ADC_AVG_SAMPLES_4};
-  uint32_t calibration_lsb_;
-  sensor::Sensor *bus_voltage_sensor_{nullptr};
-  sensor::Sensor *shunt_voltage_sensor_{nullptr};
-  sensor::Sensor *current_sensor_{nullptr};
-  sensor::Sensor *power_sensor_{nullptr};
-  sensor::Sensor *charge_coulombs_sensor_{nullptr};
-  sensor::Sensor *read_per_second_sensor_{nullptr};
-  
-  float bus_voltage_calibration_{1};
-
-  int32_t twos_complement_(int32_t val, uint8_t bits);
-
-  optional<float> latest_voltage_;
-  float latest_current_{0};
-
-  float partial_energy_mj_{0};
-
-  float partial_charge_mc_{0};
-
-  uint32_t reads_count_{0};
-  uint32_t previous_time_{0};
- 
-  uint32_t charge_reads_count_{0};
-  uint32_t charge_read_time_{0};
 };
 
 }  // namespace ina226_coulomb
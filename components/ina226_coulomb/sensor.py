@@ -21,7 +21,20 @@ from esphome.const import (
     UNIT_WATT,
     CONF_VOLTAGE,
 )
-from ..coulomb_meter import (COULOMB_SCHEMA, setup_coulomb, CoulombMeter_ns)
+from ..coulomb_meter import (
+    CAPTURE_PLATFORM_SCHEMA,
+    COULOMB_SCHEMA,
+    GAP_SCHEMA,
+    SAMPLE_STATS_SCHEMA,
+    STREAM_PLATFORM_SCHEMA,
+    CoulombMeter_ns,
+    setup_capture,
+    setup_coulomb,
+    setup_gap_detection,
+    setup_sample_stats,
+    setup_stream,
+)
+from ..i2c_async import CONF_ASYNC_READS, setup_async_reads, validate_async_reads
 DEPENDENCIES = ["i2c"]
 
 AUTO_LOAD = ["coulomb_meter"]
@@ -109,6 +122,8 @@ CONFIG_SCHEMA = (
                 state_class=STATE_CLASS_MEASUREMENT,
             ),
             cv.Optional(CONF_HIGH_FREQUENCY_LOOP, default=False): cv.boolean,
+            # needs an i2c_async bus as i2c_id, calc_charge() then never waits for the bus
+            cv.Optional(CONF_ASYNC_READS, default=False): cv.boolean,
             cv.Optional(CONF_SHUNT_RESISTANCE, default=0.1): cv.All(
                 cv.resistance, cv.Range(min=0.0)
             ),
@@ -135,9 +150,16 @@ CONFIG_SCHEMA = (
     .extend(cv.polling_component_schema("60s"))
     .extend(i2c.i2c_device_schema(0x40))
     .extend(COULOMB_SCHEMA) 
+    .extend(SAMPLE_STATS_SCHEMA)
+    .extend(GAP_SCHEMA)
+    .extend(CAPTURE_PLATFORM_SCHEMA)
+    .extend(STREAM_PLATFORM_SCHEMA)
 )
 
 
+FINAL_VALIDATE_SCHEMA = validate_async_reads
+
+
 async def to_code(config):
     var = cg.new_Pvariable(config[CONF_ID])
 
@@ -185,6 +207,11 @@ async def to_code(config):
         cg.add(var.set_high_frequency_loop())
 
 
+    await setup_sample_stats(var, config)
+    await setup_gap_detection(var, config)
+    await setup_capture(var, config)
+    await setup_stream(var, config)
+    await setup_async_reads(var, config)
     await setup_coulomb(var, config)
     await cg.register_component(var, config)
     await i2c.register_i2c_device(var, config)
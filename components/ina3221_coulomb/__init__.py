@@ -0,0 +1 @@
+CODEOWNERS = ["@SqrTT"]
@@ -0,0 +1,119 @@
+#include "ina3221_coulomb.h"
+#include "esphome/core/log.h"
+#include "esphome/core/hal.h"
+#include <cinttypes>
+
+namespace esphome {
+namespace ina3221_coulomb {
+
+static const char *const TAG = "ina3221_coulomb";
+
+// | A0   | Address |
+// | GND  | 0x40    |
+// | VS   | 0x41    |
+// | SDA  | 0x42    |
+// | SCL  | 0x43    |
+
+// shunt and bus voltage registers of the channels are in INA3221Traits
+static const uint8_t INA3221_REGISTER_CONFIG = 0x00;
+
+static const uint8_t INA3221_CHANNEL_COUNT = 3;
+
+static const uint16_t INA3221_ADC_TIMES[] = {140, 204, 332, 588, 1100, 2116, 4156, 8244};
+static const uint16_t INA3221_ADC_AVG_SAMPLES[] = {1, 4, 16, 64, 128, 256, 512, 1024};
+
+// after the channels, they only have to be set up when the interval starts
+float INA3221Component::get_setup_priority() const { return setup_priority::DATA - 1.0f; }
+
+void INA3221Component::setup() {
+  ESP_LOGCONFIG(TAG, "Setting up INA3221...");
+
+  ConfigurationRegister config;
+
+  config.raw = 0;
+  config.reset = 1;
+  if (!this->write_byte_16(INA3221_REGISTER_CONFIG, config.raw)) {
+    this->mark_failed();
+    this->for_each_channel_([](auto *channel) { channel->mark_failed(); });
+    return;
+  }
+  delay(1);
+
+  config.raw = 0;
+  // only the channels in use are converted, the others cost no conversion time
+  config.channel_enable = this->channel_mask_();
+  config.avg_samples = this->adc_avg_samples_;
+  config.bus_voltage_conversion_time = this->adc_time_voltage_;
+  config.shunt_voltage_conversion_time = this->adc_time_current_;
+  // shunt and bus, continuous
+  config.mode = 0b111;
+
+  if (!this->write_byte_16(INA3221_REGISTER_CONFIG, config.raw)) {
+    this->mark_failed();
+    this->for_each_channel_([](auto *channel) { channel->mark_failed(); });
+    return;
+  }
+
+  // the channels read their registers on the chip's bus and address
+  this->for_each_channel_([this](auto *channel) {
+    channel->set_i2c_bus(this->bus_);
+    channel->set_i2c_address(this->address_);
+  });
+
+  this->set_interval("calcCharge", 1, [this]() {
+    this->sample_next_();
+  });
+}
+
+void INA3221Component::dump_config() {
+  ESP_LOGCONFIG(TAG, "INA3221:");
+  LOG_I2C_DEVICE(this);
+
+  if (this->is_failed()) {
+    ESP_LOGE(TAG, "Communication with INA3221 failed!");
+    return;
+  }
+
+  ESP_LOGCONFIG(TAG, "  ADC Conversion Time Bus Voltage: %d", INA3221_ADC_TIMES[this->adc_time_voltage_ & 0b111]);
+  ESP_LOGCONFIG(TAG, "  ADC Conversion Time Shunt Voltage: %d", INA3221_ADC_TIMES[this->adc_time_current_ & 0b111]);
+  ESP_LOGCONFIG(TAG, "  ADC Averaging Samples: %d", INA3221_ADC_AVG_SAMPLES[this->adc_avg_samples_ & 0b111]);
+
+  // a channel gets a new sample once per round of all enabled channels
+  uint32_t channels = 0;
+  this->for_each_channel_([&channels](auto *channel) { channels++; });
+  const uint32_t round_us = channels * INA3221_ADC_AVG_SAMPLES[this->adc_avg_samples_ & 0b111] *
+                            (INA3221_ADC_TIMES[this->adc_time_voltage_ & 0b111] +
+                             INA3221_ADC_TIMES[this->adc_time_current_ & 0b111]);
+  ESP_LOGCONFIG(TAG, "  Channels: %" PRIu32 ", conversion round: %" PRIu32 " us", channels, round_us);
+}
+
+uint16_t INA3221Component::channel_mask_() const {
+  return (this->channel_1_ != nullptr ? 0b100 : 0) | (this->channel_2_ != nullptr ? 0b010 : 0) |
+         (this->channel_3_ != nullptr ? 0b001 : 0);
+}
+
+void INA3221Component::sample_next_() {
+  for (uint8_t i = 0; i < INA3221_CHANNEL_COUNT; i++) {
+    const uint8_t channel = this->next_channel_;
+    this->next_channel_ = (channel + 1) % INA3221_CHANNEL_COUNT;
+
+    bool sampled;
+    switch (channel) {
+      case 0:
+        sampled = sample_(this->channel_1_);
+        break;
+      case 1:
+        sampled = sample_(this->channel_2_);
+        break;
+      default:
+        sampled = sample_(this->channel_3_);
+        break;
+    }
+    if (sampled) {
+      return;
+    }
+  }
+}
+
+}  // namespace ina3221_coulomb
+}  // namespace esphome
@@ -0,0 +1,133 @@
+#pragma once
+
+#include "../coulomb_meter/ina_coulomb_core.h"
+
+namespace esphome {
+namespace ina3221_coulomb {
+
+enum AdcTime : uint16_t {
+  ADC_TIME_140US = 0,
+  ADC_TIME_204US = 1,
+  ADC_TIME_332US = 2,
+  ADC_TIME_588US = 3,
+  ADC_TIME_1100US = 4,
+  ADC_TIME_2116US = 5,
+  ADC_TIME_4156US = 6,
+  ADC_TIME_8244US = 7
+};
+
+enum AdcAvgSamples : uint16_t {
+  ADC_AVG_SAMPLES_1 = 0,
+  ADC_AVG_SAMPLES_4 = 1,
+  ADC_AVG_SAMPLES_16 = 2,
+  ADC_AVG_SAMPLES_64 = 3,
+  ADC_AVG_SAMPLES_128 = 4,
+  ADC_AVG_SAMPLES_256 = 5,
+  ADC_AVG_SAMPLES_512 = 6,
+  ADC_AVG_SAMPLES_1024 = 7
+};
+
+union ConfigurationRegister {
+  uint16_t raw;
+  struct {
+    uint16_t mode : 3;
+    AdcTime shunt_voltage_conversion_time : 3;
+    AdcTime bus_voltage_conversion_time : 3;
+    AdcAvgSamples avg_samples : 3;
+    // bit 2 is channel 1, bit 0 channel 3
+    uint16_t channel_enable : 3;
+    uint16_t reset : 1;
+  } __attribute__((packed));
+};
+
+// Channel N (1 to 3) has a shunt and a bus voltage register, 13 bit left
+// aligned: 40 µV and 8 mV steps. There is no current register, the shunt
+// voltage is sampled as the current with its LSB over the shunt resistance.
+template<uint8_t N> struct INA3221Traits {
+  static constexpr const char *TAG = "ina3221_coulomb";
+  static constexpr uint8_t REGISTER_SHUNT_VOLTAGE = 2 * N - 1;
+  static constexpr uint8_t REGISTER_BUS_VOLTAGE = 2 * N;
+  static constexpr uint8_t REGISTER_CURRENT = REGISTER_SHUNT_VOLTAGE;
+  static constexpr uint8_t CURRENT_SHIFT = 3;
+  static constexpr uint8_t BUS_VOLTAGE_SHIFT = 3;
+  static constexpr uint8_t SHUNT_VOLTAGE_SHIFT = 3;
+  static constexpr float BUS_VOLTAGE_LSB = 0.008f;
+  static constexpr float SHUNT_VOLTAGE_LSB = 0.00004f;
+};
+
+// One channel as its own coulomb meter. INA3221Component configures the chip
+// and samples the channels from its interval, a channel has none of its own.
+template<uint8_t N> class INA3221Channel : public coulomb_meter::InaCoulombCore<INA3221Traits<N>> {
+ public:
+  INA3221Channel() { this->sampled_by_parent_ = true; }
+
+  void setup() override {
+    this->current_lsb_a_ = INA3221Traits<N>::SHUNT_VOLTAGE_LSB / this->shunt_resistance_ohm_;
+    this->setup_core_();
+  }
+
+  void dump_config() override {
+    static constexpr const char *TAG = INA3221Traits<N>::TAG;
+    ESP_LOGCONFIG(TAG, "INA3221 Channel %u:", N);
+    if (this->is_failed()) {
+      ESP_LOGE(TAG, "Communication with INA3221 failed!");
+      return;
+    }
+    ESP_LOGCONFIG(TAG, "  Shunt Resistance: %.3f Ohm", this->shunt_resistance_ohm_);
+    this->dump_core_config_();
+  }
+};
+
+// The chip converts the enabled channels in turn. Its interval follows them:
+// every tick samples the next enabled channel, so the bus sees the register
+// reads of a single channel driver however many channels are in use.
+class INA3221Component : public Component, public i2c::I2CDevice {
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override;
+
+  void set_adc_time_voltage(AdcTime time) { adc_time_voltage_ = time; }
+  void set_adc_time_current(AdcTime time) { adc_time_current_ = time; }
+  void set_adc_avg_samples(AdcAvgSamples samples) { adc_avg_samples_ = samples; }
+
+  void set_channel_1(INA3221Channel<1> *channel) { channel_1_ = channel; }
+  void set_channel_2(INA3221Channel<2> *channel) { channel_2_ = channel; }
+  void set_channel_3(INA3221Channel<3> *channel) { channel_3_ = channel; }
+
+ protected:
+  template<typename F> void for_each_channel_(F &&f) {
+    if (this->channel_1_ != nullptr) {
+      f(this->channel_1_);
+    }
+    if (this->channel_2_ != nullptr) {
+      f(this->channel_2_);
+    }
+    if (this->channel_3_ != nullptr) {
+      f(this->channel_3_);
+    }
+  }
+  template<uint8_t N> static bool sample_(INA3221Channel<N> *channel) {
+    if (channel == nullptr || channel->is_failed()) {
+      return false;
+    }
+    channel->calc_charge();
+    return true;
+  }
+  // samples the next enabled channel after the one of the previous tick
+  void sample_next_();
+  uint16_t channel_mask_() const;
+
+  AdcTime adc_time_voltage_{AdcTime::ADC_TIME_1100US};
+  AdcTime adc_time_current_{AdcTime::ADC_TIME_1100US};
+  AdcAvgSamples adc_avg_samples_{AdcAvgSamples::ADC_AVG_SAMPLES_4};
+
+  INA3221Channel<1> *channel_1_{nullptr};
+  INA3221Channel<2> *channel_2_{nullptr};
+  INA3221Channel<3> *channel_3_{nullptr};
+  // the channel the next tick starts looking from, 0 is channel 1
+  uint8_t next_channel_{0};
+};
+
+}  // namespace ina3221_coulomb
+}  // namespace esphome
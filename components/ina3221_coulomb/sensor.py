@@ -0,0 +1,231 @@
+import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import i2c, sensor
+from esphome.const import (
+    CONF_BUS_VOLTAGE,
+    CONF_CURRENT,
+    CONF_ID,
+    CONF_POWER,
+    CONF_SHUNT_RESISTANCE,
+    CONF_SHUNT_VOLTAGE,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    DEVICE_CLASS_VOLTAGE,
+    DEVICE_CLASS_CURRENT,
+    DEVICE_CLASS_POWER,
+    STATE_CLASS_MEASUREMENT,
+    UNIT_VOLT,
+    UNIT_HERTZ,
+    UNIT_AMPERE,
+    UNIT_WATT,
+    CONF_VOLTAGE,
+)
+from ..coulomb_meter import (
+    CAPTURE_PLATFORM_SCHEMA,
+    COULOMB_SCHEMA,
+    GAP_SCHEMA,
+    SAMPLE_STATS_SCHEMA,
+    STREAM_PLATFORM_SCHEMA,
+    CoulombMeter_ns,
+    setup_capture,
+    setup_coulomb,
+    setup_gap_detection,
+    setup_sample_stats,
+    setup_stream,
+)
+DEPENDENCIES = ["i2c"]
+
+AUTO_LOAD = ["coulomb_meter"]
+
+CONF_ADC_AVERAGING = "adc_averaging"
+CONF_ADC_TIME = "adc_time"
+CONF_CHARGE_COULOMBS = "charge_coulombs"
+CONF_BUS_VOLTAGE_CALIBRATION = "bus_voltage_calibration"
+CONF_READ_PER_SECOND = "read_per_second"
+CONF_CHANNEL_1 = "channel_1"
+CONF_CHANNEL_2 = "channel_2"
+CONF_CHANNEL_3 = "channel_3"
+UNIT_COULOMB = "C"
+
+ina3221_ns = cg.esphome_ns.namespace("ina3221_coulomb")
+INA3221Component = ina3221_ns.class_(
+    "INA3221Component", cg.Component, i2c.I2CDevice
+)
+INA3221Channel = ina3221_ns.class_(
+    "INA3221Channel", CoulombMeter_ns, i2c.I2CDevice
+)
+
+AdcTime = ina3221_ns.enum("AdcTime")
+ADC_TIMES = {
+    140: AdcTime.ADC_TIME_140US,
+    204: AdcTime.ADC_TIME_204US,
+    332: AdcTime.ADC_TIME_332US,
+    588: AdcTime.ADC_TIME_588US,
+    1100: AdcTime.ADC_TIME_1100US,
+    2116: AdcTime.ADC_TIME_2116US,
+    4156: AdcTime.ADC_TIME_4156US,
+    8244: AdcTime.ADC_TIME_8244US,
+}
+
+AdcAvgSamples = ina3221_ns.enum("AdcAvgSamples")
+ADC_AVG_SAMPLES = {
+    1: AdcAvgSamples.ADC_AVG_SAMPLES_1,
+    4: AdcAvgSamples.ADC_AVG_SAMPLES_4,
+    16: AdcAvgSamples.ADC_AVG_SAMPLES_16,
+    64: AdcAvgSamples.ADC_AVG_SAMPLES_64,
+    128: AdcAvgSamples.ADC_AVG_SAMPLES_128,
+    256: AdcAvgSamples.ADC_AVG_SAMPLES_256,
+    512: AdcAvgSamples.ADC_AVG_SAMPLES_512,
+    1024: AdcAvgSamples.ADC_AVG_SAMPLES_1024,
+}
+
+CHANNELS = {
+    CONF_CHANNEL_1: 1,
+    CONF_CHANNEL_2: 2,
+    CONF_CHANNEL_3: 3,
+}
+
+
+def validate_adc_time(value):
+    value = cv.positive_time_period_microseconds(value).total_microseconds
+    return cv.enum(ADC_TIMES, int=True)(value)
+
+
+# every channel is a coulomb meter of its own
+CHANNEL_SCHEMA = (
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(INA3221Channel),
+            cv.Optional(CONF_BUS_VOLTAGE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_VOLT,
+                accuracy_decimals=2,
+                device_class=DEVICE_CLASS_VOLTAGE,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_READ_PER_SECOND): sensor.sensor_schema(
+                unit_of_measurement=UNIT_HERTZ,
+                accuracy_decimals=1,
+                entity_category=ENTITY_CATEGORY_DIAGNOSTIC
+            ),
+            cv.Optional(CONF_SHUNT_VOLTAGE): sensor.sensor_schema(
+                unit_of_measurement=UNIT_VOLT,
+                accuracy_decimals=3,
+                device_class=DEVICE_CLASS_VOLTAGE,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_CURRENT): sensor.sensor_schema(
+                unit_of_measurement=UNIT_AMPERE,
+                accuracy_decimals=3,
+                device_class=DEVICE_CLASS_CURRENT,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_POWER): sensor.sensor_schema(
+                unit_of_measurement=UNIT_WATT,
+                accuracy_decimals=2,
+                device_class=DEVICE_CLASS_POWER,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_CHARGE_COULOMBS): sensor.sensor_schema(
+                unit_of_measurement=UNIT_COULOMB,
+                accuracy_decimals=0,
+                state_class=STATE_CLASS_MEASUREMENT,
+            ),
+            cv.Optional(CONF_SHUNT_RESISTANCE, default=0.1): cv.All(
+                cv.resistance, cv.Range(min=0.0, min_included=False)
+            ),
+            cv.Optional(CONF_BUS_VOLTAGE_CALIBRATION, default=1): cv.All(
+                cv.positive_float, cv.Range(min=0.0)
+            ),
+        }
+    )
+    .extend(cv.polling_component_schema("60s"))
+    .extend(COULOMB_SCHEMA)
+    .extend(SAMPLE_STATS_SCHEMA)
+    .extend(GAP_SCHEMA)
+    .extend(CAPTURE_PLATFORM_SCHEMA)
+    .extend(STREAM_PLATFORM_SCHEMA)
+)
+
+CONFIG_SCHEMA = cv.All(
+    cv.Schema(
+        {
+            cv.GenerateID(): cv.declare_id(INA3221Component),
+            cv.Optional(CONF_CHANNEL_1): CHANNEL_SCHEMA,
+            cv.Optional(CONF_CHANNEL_2): CHANNEL_SCHEMA,
+            cv.Optional(CONF_CHANNEL_3): CHANNEL_SCHEMA,
+            cv.Optional(CONF_ADC_TIME, default="1100 us"): cv.Any(
+                validate_adc_time,
+                cv.Schema(
+                    {
+                        cv.Required(CONF_VOLTAGE): validate_adc_time,
+                        cv.Required(CONF_CURRENT): validate_adc_time,
+                    }
+                ),
+            ),
+            cv.Optional(CONF_ADC_AVERAGING, default=4): cv.enum(
+                ADC_AVG_SAMPLES, int=True
+            ),
+        }
+    )
+    .extend(cv.COMPONENT_SCHEMA)
+    .extend(i2c.i2c_device_schema(0x40)),
+    cv.has_at_least_one_key(*CHANNELS),
+)
+
+
+async def channel_to_code(hub, number, config):
+    var = cg.new_Pvariable(config[CONF_ID], cg.TemplateArguments(number))
+    await cg.register_component(var, config)
+
+    cg.add(var.set_shunt_resistance_ohm(config[CONF_SHUNT_RESISTANCE]))
+    cg.add(var.set_bus_voltage_calibration(config[CONF_BUS_VOLTAGE_CALIBRATION]))
+
+    if CONF_BUS_VOLTAGE in config:
+        sens = await sensor.new_sensor(config[CONF_BUS_VOLTAGE])
+        cg.add(var.set_bus_voltage_sensor(sens))
+
+    if CONF_SHUNT_VOLTAGE in config:
+        sens = await sensor.new_sensor(config[CONF_SHUNT_VOLTAGE])
+        cg.add(var.set_shunt_voltage_sensor(sens))
+
+    if CONF_CURRENT in config:
+        sens = await sensor.new_sensor(config[CONF_CURRENT])
+        cg.add(var.set_current_sensor(sens))
+
+    if CONF_POWER in config:
+        sens = await sensor.new_sensor(config[CONF_POWER])
+        cg.add(var.set_power_sensor(sens))
+
+    if conf := config.get(CONF_CHARGE_COULOMBS):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_charge_coulombs_sensor(sens))
+
+    if conf := config.get(CONF_READ_PER_SECOND):
+        sens = await sensor.new_sensor(conf)
+        cg.add(var.set_read_per_second_sensor(sens))
+
+    await setup_sample_stats(var, config)
+    await setup_gap_detection(var, config)
+    await setup_capture(var, config)
+    await setup_stream(var, config)
+    await setup_coulomb(var, config)
+    cg.add(getattr(hub, f"set_channel_{number}")(var))
+
+
+async def to_code(config):
+    var = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(var, config)
+    await i2c.register_i2c_device(var, config)
+
+    adc_time_config = config[CONF_ADC_TIME]
+    if isinstance(adc_time_config, dict):
+        cg.add(var.set_adc_time_voltage(adc_time_config[CONF_VOLTAGE]))
+        cg.add(var.set_adc_time_current(adc_time_config[CONF_CURRENT]))
+    else:
+        cg.add(var.set_adc_time_voltage(adc_time_config))
+        cg.add(var.set_adc_time_current(adc_time_config))
+
+    cg.add(var.set_adc_avg_samples(config[CONF_ADC_AVERAGING]))
+
+    for key, number in CHANNELS.items():
+        if conf := config.get(key):
+            await channel_to_code(var, number, conf)
@@ -1,3 +1,180 @@
 import esphome.codegen as cg
+import esphome.config_validation as cv
+from esphome.components import sensor
+from esphome.const import (
+    CONF_ID,
+    CONF_LAMBDA,
+    ENTITY_CATEGORY_DIAGNOSTIC,
+    STATE_CLASS_MEASUREMENT,
+    STATE_CLASS_TOTAL_INCREASING,
+)
+from esphome.core import CORE, ID, EsphomeError, coroutine_with_priority
 
-template_ns = cg.esphome_ns.namespace("reactive_template_")
\ No newline at end of file
+# profiling publishes through diagnostic sensors
+AUTO_LOAD = ["sensor"]
+
+template_ns = cg.esphome_ns.namespace("reactive_template_")
+ReactiveEngine = template_ns.class_("ReactiveEngine", cg.Component)
+ReactiveProfile = template_ns.class_("ReactiveProfile", cg.PollingComponent)
+
+ReactiveStrategy = template_ns.enum("ReactiveStrategy")
+STRATEGIES = {
+    "immediate": ReactiveStrategy.REACTIVE_IMMEDIATE,
+    "leading": ReactiveStrategy.REACTIVE_LEADING,
+    "trailing": ReactiveStrategy.REACTIVE_TRAILING,
+    "throttle": ReactiveStrategy.REACTIVE_THROTTLE,
+}
+
+CONF_STRATEGY = "strategy"
+CONF_WINDOW = "window"
+CONF_MEMOIZE = "memoize"
+CONF_PROFILING = "profiling"
+CONF_EVALUATIONS = "evaluations"
+CONF_SUPPRESSED = "suppressed"
+CONF_MIN_TIME = "min_time"
+CONF_AVG_TIME = "avg_time"
+CONF_MAX_TIME = "max_time"
+
+UNIT_MICROSECOND = "µs"
+
+_COUNTER_SENSOR = sensor.sensor_schema(
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_TOTAL_INCREASING,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+_TIME_SENSOR = sensor.sensor_schema(
+    unit_of_measurement=UNIT_MICROSECOND,
+    accuracy_decimals=0,
+    state_class=STATE_CLASS_MEASUREMENT,
+    entity_category=ENTITY_CATEGORY_DIAGNOSTIC,
+)
+
+PROFILING_SCHEMA = cv.Schema(
+    {
+        cv.GenerateID(): cv.declare_id(ReactiveProfile),
+        cv.Optional(CONF_EVALUATIONS): _COUNTER_SENSOR,
+        cv.Optional(CONF_SUPPRESSED): _COUNTER_SENSOR,
+        cv.Optional(CONF_MIN_TIME): _TIME_SENSOR,
+        cv.Optional(CONF_AVG_TIME): _TIME_SENSOR,
+        cv.Optional(CONF_MAX_TIME): _TIME_SENSOR,
+    }
+).extend(cv.polling_component_schema("60s"))
+
+REACTIVE_SCHEMA = cv.Schema(
+    {
+        cv.Optional(CONF_STRATEGY, default="immediate"): cv.enum(STRATEGIES, lower=True),
+        cv.Optional(CONF_WINDOW, default="40ms"): cv.positive_time_period_milliseconds,
+        # skip the lambda when all inputs are bit-identical to the last evaluation
+        cv.Optional(CONF_MEMOIZE, default=True): cv.boolean,
+        # time every evaluation, results show in dump_config and the optional sensors
+        cv.Optional(CONF_PROFILING): PROFILING_SCHEMA,
+    }
+)
+
+DOMAIN = "reactive_template"
+# ReactiveNode tracks input validity in a 32 bit mask
+MAX_INPUTS = 32
+
+
+def register_node(node_id, depends_on):
+    """Add a reactive template and the ids it reads to the dependency graph.
+
+    The engine is generated once, after all platforms have registered their nodes.
+    """
+    if len(depends_on) > MAX_INPUTS:
+        raise EsphomeError(f"Reactive template '{node_id.id}' reads {len(depends_on)} entities, at most {MAX_INPUTS} are supported")
+    graph = CORE.data.setdefault(DOMAIN, {})
+    if not graph:
+        CORE.add_job(_engine_to_code)
+    graph[node_id.id] = (node_id, [dep.id for dep in depends_on])
+
+
+def declare_node_function(node_id, return_type):
+    """Forward declare the free function that holds the lambda of a reactive template.
+
+    Lambda nodes take it as template argument, so it is declared before the node
+    itself; define_node_function() adds the body once the lambda was processed.
+    """
+    function = f"{node_id.id}_reactive_lambda"
+    cg.add_global(cg.RawStatement(f"static {return_type} {function}();"))
+    return cg.RawExpression(function)
+
+
+def define_node_function(function, return_type, body):
+    # process_lambda() waited for every id the body uses, all are declared by now
+    cg.add_global(cg.RawStatement(f"static {return_type} {function}() {{\n{body}\n}}"))
+
+
+async def new_lambda_node(config, lambda_class, return_type, depends_on, new_entity, body=None, **kwargs):
+    """Create the entity of a reactive template with a lambda as lambda_class<function, inputs>.
+
+    body replaces the lambda of the config, for nodes that build it otherwise.
+    """
+    function = declare_node_function(config[CONF_ID], return_type)
+    config[CONF_ID].type = lambda_class
+    var = await new_entity(config, cg.TemplateArguments(function, len(depends_on)), **kwargs)
+    if body is None:
+        template_ = await cg.process_lambda(config[CONF_LAMBDA], [], return_type=return_type)
+        body = template_.content
+    define_node_function(function, return_type, body)
+    return var
+
+
+async def setup_reactive_node(var, config, depends_on):
+    if config[CONF_STRATEGY] != "immediate":
+        cg.add(var.set_strategy(config[CONF_STRATEGY], config[CONF_WINDOW]))
+    if not config[CONF_MEMOIZE]:
+        cg.add(var.set_memoize(False))
+    if profiling := config.get(CONF_PROFILING):
+        await profiling_to_code(var, profiling)
+    register_node(config[CONF_ID], depends_on)
+
+
+async def profiling_to_code(node, config):
+    cg.add_define("USE_REACTIVE_TEMPLATE_PROFILING")
+    profile = cg.new_Pvariable(config[CONF_ID])
+    await cg.register_component(profile, config)
+    cg.add(profile.set_node(node))
+    for key, setter in (
+        (CONF_EVALUATIONS, profile.set_evaluations_sensor),
+        (CONF_SUPPRESSED, profile.set_suppressed_sensor),
+        (CONF_MIN_TIME, profile.set_min_time_sensor),
+        (CONF_AVG_TIME, profile.set_avg_time_sensor),
+        (CONF_MAX_TIME, profile.set_max_time_sensor),
+    ):
+        if conf := config.get(key):
+            sens = await sensor.new_sensor(conf)
+            cg.add(setter(sens))
+
+
+def topological_order(graph):
+    # only edges between reactive templates matter, other ids are plain inputs
+    order = []
+    state = {}
+
+    def visit(node, path):
+        if state.get(node) == "done":
+            return
+        if state.get(node) == "visiting":
+            cycle = path[path.index(node):] + [node]
+            raise EsphomeError(f"Dependency cycle between reactive templates: {' -> '.join(cycle)}")
+        state[node] = "visiting"
+        for dep in graph[node][1]:
+            if dep in graph:
+                visit(dep, path + [node])
+        state[node] = "done"
+        order.append(node)
+
+    for node in graph:
+        visit(node, [])
+    return order
+
+
+@coroutine_with_priority(-100.0)
+async def _engine_to_code():
+    graph = CORE.data[DOMAIN]
+    engine = cg.new_Pvariable(ID("reactive_template_engine", is_declaration=True, type=ReactiveEngine))
+    await cg.register_component(engine, {})
+    for node in topological_order(graph):
+        var = await cg.get_variable(graph[node][0])
+        cg.add(engine.add_node(var))
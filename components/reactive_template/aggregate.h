@@ -0,0 +1,161 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace esphome {
+namespace reactive_template_ {
+
+enum AggregateType : uint8_t {
+  AGGREGATE_MEAN,
+  AGGREGATE_MIN,
+  AGGREGATE_MAX,
+  AGGREGATE_SUM,
+  AGGREGATE_INTEGRAL,
+  AGGREGATE_EWMA,
+};
+
+// Fixed capacity ring used as a deque, the storage is allocated once in init().
+template<typename T> class BoundedDeque {
+ public:
+  void init(uint16_t capacity) {
+    this->items_.resize(capacity);
+    this->head_ = 0;
+    this->size_ = 0;
+  }
+
+  bool empty() const { return this->size_ == 0; }
+  bool full() const { return this->size_ == this->items_.size(); }
+  uint16_t size() const { return this->size_; }
+
+  T &front() { return this->items_[this->head_]; }
+  T &back() { return this->items_[this->wrap_(this->head_ + this->size_ - 1)]; }
+
+  void push_back(const T &item) {
+    this->items_[this->wrap_(this->head_ + this->size_)] = item;
+    this->size_++;
+  }
+  void pop_front() {
+    this->head_ = this->wrap_(this->head_ + 1);
+    this->size_--;
+  }
+  void pop_back() { this->size_--; }
+
+ protected:
+  uint16_t wrap_(uint32_t index) const { return index >= this->items_.size() ? index - this->items_.size() : index; }
+
+  std::vector<T> items_;
+  uint16_t head_{0};
+  uint16_t size_{0};
+};
+
+// Samples of one time slice (time windows) or a single sample (count windows).
+struct AggregateBucket {
+  double sum{0};
+  double area{0};
+  float min{std::numeric_limits<float>::infinity()};
+  float max{-std::numeric_limits<float>::infinity()};
+  uint32_t count{0};
+
+  void add(float value, float area) {
+    this->sum += value;
+    this->area += area;
+    this->min = std::fmin(this->min, value);
+    this->max = std::fmax(this->max, value);
+    this->count++;
+  }
+};
+
+// Sliding window over the last `capacity` closed buckets plus the open one.
+// Sum, count and integral are running totals, min and max come from monotonic
+// deques of bucket extremes, so adding a sample and closing a bucket are O(1)
+// amortized and the memory is fixed by the bucket count.
+class SlidingAggregate {
+ public:
+  void init(uint16_t capacity) {
+    this->closed_.init(capacity);
+    this->mins_.init(capacity);
+    this->maxs_.init(capacity);
+    this->open_ = {};
+    this->total_ = {};
+    this->seq_ = 0;
+  }
+
+  void add(float value, float area) { this->open_.add(value, area); }
+
+  void close_bucket() {
+    if (this->closed_.full()) {
+      const AggregateBucket &oldest = this->closed_.front();
+      this->total_.sum -= oldest.sum;
+      this->total_.area -= oldest.area;
+      this->total_.count -= oldest.count;
+      this->closed_.pop_front();
+    }
+    this->closed_.push_back(this->open_);
+    this->total_.sum += this->open_.sum;
+    this->total_.area += this->open_.area;
+    this->total_.count += this->open_.count;
+
+    // drop extremes of buckets that left the window first, the deques only have
+    // room for one entry per bucket in the window
+    const uint32_t first_seq = this->seq_ + 1 - this->closed_.size();
+    while (!this->mins_.empty() && (int32_t) (this->mins_.front().seq - first_seq) < 0) {
+      this->mins_.pop_front();
+    }
+    while (!this->maxs_.empty() && (int32_t) (this->maxs_.front().seq - first_seq) < 0) {
+      this->maxs_.pop_front();
+    }
+
+    // empty buckets have no extremes, expiry above still works by sequence number
+    if (this->open_.count != 0) {
+      while (!this->mins_.empty() && this->mins_.back().value >= this->open_.min) {
+        this->mins_.pop_back();
+      }
+      this->mins_.push_back({this->seq_, this->open_.min});
+      while (!this->maxs_.empty() && this->maxs_.back().value <= this->open_.max) {
+        this->maxs_.pop_back();
+      }
+      this->maxs_.push_back({this->seq_, this->open_.max});
+    }
+    this->seq_++;
+    this->open_ = {};
+  }
+
+  uint32_t count() const { return this->total_.count + this->open_.count; }
+  float sum() const { return this->total_.sum + this->open_.sum; }
+  float integral() const { return this->total_.area + this->open_.area; }
+  float mean() const {
+    const uint32_t count = this->count();
+    return count == 0 ? NAN : this->sum() / count;
+  }
+  float min() {
+    if (this->count() == 0) {
+      return NAN;
+    }
+    return this->mins_.empty() ? this->open_.min : std::fmin(this->mins_.front().value, this->open_.min);
+  }
+  float max() {
+    if (this->count() == 0) {
+      return NAN;
+    }
+    return this->maxs_.empty() ? this->open_.max : std::fmax(this->maxs_.front().value, this->open_.max);
+  }
+
+ protected:
+  struct Extreme {
+    uint32_t seq;
+    float value;
+  };
+
+  BoundedDeque<AggregateBucket> closed_;
+  BoundedDeque<Extreme> mins_;
+  BoundedDeque<Extreme> maxs_;
+  AggregateBucket open_;
+  AggregateBucket total_;
+  uint32_t seq_{0};
+};
+
+}  // namespace reactive_template_
+}  // namespace esphome
@@ -3,13 +3,21 @@ import esphome.codegen as cg
 from esphome.components import binary_sensor
 import esphome.config_validation as cv
 from esphome.const import CONF_CONDITION, CONF_ID, CONF_LAMBDA, CONF_STATE
-from esphome.cpp_generator import LambdaExpression
 
-from .. import template_ns
+from .. import (
+    template_ns,
+    setup_reactive_node,
+    new_lambda_node,
+    REACTIVE_SCHEMA,
+)
 
 ReactiveTemplateBinarySensor = template_ns.class_(
     "ReactiveTemplateBinarySensor", binary_sensor.BinarySensor, cg.Component
 )
+# ReactiveLambdaBinarySensor<function, inputs>, declared per lambda or condition
+ReactiveLambdaBinarySensor = template_ns.class_(
+    "ReactiveLambdaBinarySensor", ReactiveTemplateBinarySensor
+)
 
 CONFIG_SCHEMA = (
     binary_sensor.binary_sensor_schema(ReactiveTemplateBinarySensor)
@@ -23,31 +31,40 @@ CONFIG_SCHEMA = (
             #cv.Optional(CONF_SENSORS): cv.ensure_list(cv.use_id(sensor.Sensor)),
         }
     )
+    .extend(REACTIVE_SCHEMA)
     .extend(cv.COMPONENT_SCHEMA)
 )
 
 
 async def to_code(config):
-    var = await binary_sensor.new_binary_sensor(config)
-    await cg.register_component(var, config)
+    lamb = config.get(CONF_LAMBDA)
+    condition = config.get(CONF_CONDITION)
+    depends_on = lamb.requires_ids if lamb else []
 
-    if lamb := config.get(CONF_LAMBDA):
-        template_ = await cg.process_lambda(
-            lamb, [], return_type=cg.optional.template(bool)
+    if lamb is None and condition is None:
+        var = await binary_sensor.new_binary_sensor(config)
+    else:
+        body = None
+        if condition is not None:
+            # a condition is checked by a body of its own instead of a lambda
+            condition = await automation.build_condition(
+                condition, cg.TemplateArguments(), []
+            )
+            body = f"return {condition.check()};"
+        var = await new_lambda_node(
+            config,
+            ReactiveLambdaBinarySensor,
+            cg.optional.template(bool),
+            depends_on,
+            binary_sensor.new_binary_sensor,
+            body=body,
         )
-        cg.add(var.set_template(template_))
-    if condition := config.get(CONF_CONDITION):
-        condition = await automation.build_condition(
-            condition, cg.TemplateArguments(), []
-        )
-        template_ = LambdaExpression(
-            f"return {condition.check()};", [], return_type=cg.optional.template(bool)
-        )
-        cg.add(var.set_template(template_))
+    await cg.register_component(var, config)
 
-    for s in config[CONF_LAMBDA].requires_ids:
+    for s in depends_on:
         sens = await cg.get_variable(s)
         cg.add(var.add_to_track(sens))
+    await setup_reactive_node(var, config, depends_on)
 
 
 @automation.register_action(
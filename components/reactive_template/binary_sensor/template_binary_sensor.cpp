@@ -13,38 +13,27 @@ void ReactiveTemplateBinarySensor::setup() {
 
 #ifdef USE_SENSOR
 void ReactiveTemplateBinarySensor::add_to_track(sensor::Sensor *sensor_to_add) {
-  sensor_to_add->add_on_state_callback([this](float state) {
-    this->execute();
+  const uint8_t slot = this->add_input_(float_bits_(sensor_to_add->state), true);
+  sensor_to_add->add_on_state_callback([this, slot](float state) {
+    this->input_changed_(slot, float_bits_(state), true);
   });
 }
 #endif
 
-void ReactiveTemplateBinarySensor::execute() {
-  #ifdef ESPHOME_LOG_HAS_WARN
-  if (this->f_ == nullptr) {
-    ESP_LOGW(TAG, "No template function set for Reactive Template Binary Sensor '%s'", this->get_name().c_str());
-    return;
-  }
-  #endif
-  // debounce call
-  this->set_timeout("updateValue", 40, [this]() {
-    auto val = (this->f_)();
-    if (val.has_value()) {
-      this->publish_state(*val);
-    }
-  });
-}
-
 
 void ReactiveTemplateBinarySensor::add_to_track(binary_sensor::BinarySensor *sensor_to_add) {
-  sensor_to_add->add_on_state_callback([this](float state) {
-    this->execute();
+  const uint8_t slot = this->add_input_(sensor_to_add->state, true);
+  sensor_to_add->add_on_state_callback([this, slot](bool state) {
+    this->input_changed_(slot, state, true);
   });
 }
 
 
 
-void ReactiveTemplateBinarySensor::dump_config() { LOG_BINARY_SENSOR("", "Template Binary Sensor", this); }
+void ReactiveTemplateBinarySensor::dump_config() {
+  LOG_BINARY_SENSOR("", "Template Binary Sensor", this);
+  this->dump_reactive_config(TAG);
+}
 
 }  // namespace template_
 }  // namespace esphome
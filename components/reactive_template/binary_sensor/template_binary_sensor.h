@@ -6,14 +6,15 @@
 #ifdef USE_SENSOR
   #include "esphome/components/sensor/sensor.h"
 #endif
+#include "../reactive_engine.h"
 
 namespace esphome {
 namespace reactive_template_ {
 
-class ReactiveTemplateBinarySensor : public Component, public binary_sensor::BinarySensor {
+// Reactive binary sensor without a lambda of its own, published by actions only.
+// Binary sensors with a lambda or condition are ReactiveLambdaBinarySensor.
+class ReactiveTemplateBinarySensor : public Component, public binary_sensor::BinarySensor, public ReactiveNode {
  public:
-  void set_template(std::function<optional<bool>()> &&f) { this->f_ = f; }
-
   void setup() override;
 
   void dump_config() override;
@@ -26,10 +27,27 @@ class ReactiveTemplateBinarySensor : public Component, public binary_sensor::Bin
   void add_to_track(sensor::Sensor *sensor_to_add);
   #endif 
 
+  void evaluate() override {}
+
  protected:
-  void execute();
-  std::function<optional<bool>()> f_{nullptr};
+  void publish_result_(optional<bool> val) {
+    if (val.has_value()) {
+      this->publish_state(*val);
+    }
+  }
+};
+
+// F is the configured lambda or condition as a free function, called directly.
+// N is the number of add_to_track() inputs.
+template<optional<bool> (*F)(), size_t N>
+class ReactiveLambdaBinarySensor : public ReactiveTemplateBinarySensor, protected ReactiveInputs<N> {
+ public:
+  ReactiveLambdaBinarySensor() {
+    this->set_input_storage_(this->input_storage_.data(), this->evaluated_storage_.data());
+  }
+
+  void evaluate() override { this->publish_result_(F()); }
 };
 
-}  // namespace template_
+}  // namespace reactive_template_
 }  // namespace esphome
@@ -0,0 +1,84 @@
+from esphome import automation
+import esphome.codegen as cg
+from esphome.components import number
+import esphome.config_validation as cv
+from esphome.const import (
+    CONF_LAMBDA,
+    CONF_MAX_VALUE,
+    CONF_MIN_VALUE,
+    CONF_OPTIMISTIC,
+    CONF_SET_ACTION,
+    CONF_STEP,
+)
+
+from .. import template_ns, setup_reactive_node, new_lambda_node, REACTIVE_SCHEMA
+
+ReactiveTemplateNumber = template_ns.class_(
+    "ReactiveTemplateNumber", number.Number, cg.Component
+)
+# ReactiveLambdaNumber<function, inputs>, declared per number with a lambda
+ReactiveLambdaNumber = template_ns.class_("ReactiveLambdaNumber", ReactiveTemplateNumber)
+
+
+def validate_min_max(config):
+    if config[CONF_MAX_VALUE] <= config[CONF_MIN_VALUE]:
+        raise cv.Invalid("max_value must be greater than min_value")
+    return config
+
+
+def validate_optimistic(config):
+    # the lambda owns the state, an optimistic value would be overwritten by the next evaluation
+    if CONF_LAMBDA in config and config[CONF_OPTIMISTIC]:
+        raise cv.Invalid(f"'{CONF_OPTIMISTIC}' cannot be used with '{CONF_LAMBDA}'")
+    return config
+
+
+CONFIG_SCHEMA = cv.All(
+    number.number_schema(ReactiveTemplateNumber)
+    .extend(
+        {
+            cv.Required(CONF_MIN_VALUE): cv.float_,
+            cv.Required(CONF_MAX_VALUE): cv.float_,
+            cv.Required(CONF_STEP): cv.positive_float,
+            cv.Optional(CONF_LAMBDA): cv.returning_lambda,
+            cv.Optional(CONF_OPTIMISTIC, default=False): cv.boolean,
+            cv.Optional(CONF_SET_ACTION): automation.validate_automation(single=True),
+        }
+    )
+    .extend(REACTIVE_SCHEMA)
+    .extend(cv.COMPONENT_SCHEMA),
+    validate_min_max,
+    validate_optimistic,
+)
+
+
+async def to_code(config):
+    limits = {
+        "min_value": config[CONF_MIN_VALUE],
+        "max_value": config[CONF_MAX_VALUE],
+        "step": config[CONF_STEP],
+    }
+    depends_on = []
+    if lamb := config.get(CONF_LAMBDA):
+        depends_on = lamb.requires_ids
+        var = await new_lambda_node(
+            config,
+            ReactiveLambdaNumber,
+            cg.optional.template(float),
+            depends_on,
+            number.new_number,
+            **limits,
+        )
+    else:
+        var = await number.new_number(config, **limits)
+    await cg.register_component(var, config)
+
+    if config[CONF_OPTIMISTIC]:
+        cg.add(var.set_optimistic(True))
+    if set_action := config.get(CONF_SET_ACTION):
+        await automation.build_automation(var.get_set_trigger(), [(float, "x")], set_action)
+
+    for s in depends_on:
+        sens = await cg.get_variable(s)
+        cg.add(var.add_to_track(sens))
+    await setup_reactive_node(var, config, depends_on)
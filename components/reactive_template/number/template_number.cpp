@@ -0,0 +1,67 @@
+#include "template_number.h"
+#include "esphome/core/log.h"
+#include <cmath>
+
+namespace esphome {
+namespace reactive_template_ {
+
+static const char *const TAG = "reactive.template.number";
+
+void ReactiveTemplateNumber::setup() {
+  this->disable_loop();
+}
+
+void ReactiveTemplateNumber::dump_config() {
+  LOG_NUMBER("", "Reactive Template Number", this);
+  ESP_LOGCONFIG(TAG, "  Optimistic: %s", YESNO(this->optimistic_));
+  this->dump_reactive_config(TAG);
+  ESP_LOGCONFIG(TAG, "  Suppressed publishes: %u", this->suppressed_publishes_);
+}
+
+void ReactiveTemplateNumber::control(float value) {
+  this->set_trigger_->trigger(value);
+  if (this->optimistic_) {
+    this->publish_state(value);
+  }
+}
+
+void ReactiveTemplateNumber::publish_result_(optional<float> val) {
+  if (!val.has_value()) {
+    return;
+  }
+  if (this->has_state() && float_bits_(*val) == float_bits_(this->state)) {
+    this->suppressed_publishes_++;
+    return;
+  }
+  this->publish_state(*val);
+}
+
+void ReactiveTemplateNumber::add_to_track(number::Number *number_to_add) {
+  const float state = number_to_add->state;
+  const uint8_t slot = this->add_input_(float_bits_(state), !std::isnan(state));
+  number_to_add->add_on_state_callback([this, slot](float state) {
+    this->input_changed_(slot, float_bits_(state), !std::isnan(state));
+  });
+}
+
+#ifdef USE_SENSOR
+void ReactiveTemplateNumber::add_to_track(sensor::Sensor *sensor_to_add) {
+  const float state = sensor_to_add->state;
+  const uint8_t slot = this->add_input_(float_bits_(state), !std::isnan(state));
+  sensor_to_add->add_on_state_callback([this, slot](float state) {
+    this->input_changed_(slot, float_bits_(state), !std::isnan(state));
+  });
+}
+#endif
+
+#ifdef USE_BINARY_SENSOR
+void ReactiveTemplateNumber::add_to_track(binary_sensor::BinarySensor *sensor_to_add) {
+  const uint8_t slot = this->add_input_(sensor_to_add->state, true);
+  sensor_to_add->add_on_state_callback([this, slot](bool state) {
+    this->input_changed_(slot, state, true);
+  });
+}
+#endif
+
+}  // namespace reactive_template_
+}  // namespace esphome
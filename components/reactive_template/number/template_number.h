@@ -0,0 +1,61 @@
+#pragma once
+
+#include "esphome/core/automation.h"
+#include "esphome/core/component.h"
+#include "esphome/components/number/number.h"
+#ifdef USE_SENSOR
+  #include "esphome/components/sensor/sensor.h"
+#endif
+#ifdef USE_BINARY_SENSOR
+  #include "esphome/components/binary_sensor/binary_sensor.h"
+#endif
+#include "../reactive_engine.h"
+
+namespace esphome {
+namespace reactive_template_ {
+
+// Reactive number without a lambda of its own, set by the user or by actions.
+// Numbers computed by a lambda are ReactiveLambdaNumber.
+class ReactiveTemplateNumber : public number::Number, public Component, public ReactiveNode {
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void set_optimistic(bool optimistic) { this->optimistic_ = optimistic; }
+  Trigger<float> *get_set_trigger() const { return this->set_trigger_; }
+
+  void add_to_track(number::Number *number_to_add);
+  #ifdef USE_SENSOR
+  void add_to_track(sensor::Sensor *sensor_to_add);
+  #endif
+  #ifdef USE_BINARY_SENSOR
+  void add_to_track(binary_sensor::BinarySensor *sensor_to_add);
+  #endif
+
+  void evaluate() override {}
+
+  uint32_t get_suppressed_count() const override { return this->skipped_evaluations_ + this->suppressed_publishes_; }
+
+ protected:
+  void control(float value) override;
+  // a result equal to the current value is dropped, NAN inputs keep the last value
+  void publish_result_(optional<float> val);
+
+  bool optimistic_{false};
+  Trigger<float> *set_trigger_ = new Trigger<float>();
+  uint32_t suppressed_publishes_{0};
+};
+
+// F is the configured lambda as a free function, called directly.
+// N is the number of add_to_track() inputs.
+template<optional<float> (*F)(), size_t N>
+class ReactiveLambdaNumber : public ReactiveTemplateNumber, protected ReactiveInputs<N> {
+ public:
+  ReactiveLambdaNumber() { this->set_input_storage_(this->input_storage_.data(), this->evaluated_storage_.data()); }
+
+  void evaluate() override { this->publish_result_(F()); }
+};
+
+}  // namespace reactive_template_
+}  // namespace esphome
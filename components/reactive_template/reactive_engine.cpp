@@ -0,0 +1,220 @@
+#include "reactive_engine.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace reactive_template_ {
+
+static const char *const TAG = "reactive.template.engine";
+
+void ReactiveNode::mark_dirty() {
+  if (this->dirty_) {
+    return;
+  }
+  this->dirty_ = true;
+  if (this->engine_ != nullptr) {
+    this->engine_->schedule(this);
+  }
+}
+
+void ReactiveNode::dump_reactive_config(const char *tag) const {
+  if (this->strategy_ == REACTIVE_IMMEDIATE) {
+    ESP_LOGCONFIG(tag, "  Strategy: immediate");
+  } else {
+    ESP_LOGCONFIG(tag, "  Strategy: %s, window %u ms", reactive_strategy_to_str(this->strategy_), this->window_ms_);
+  }
+  ESP_LOGCONFIG(tag, "  Memoize: %s", YESNO(this->memoize_));
+  ESP_LOGCONFIG(tag, "  Evaluations: %u, collapsed input changes: %u, skipped (inputs unchanged): %u", this->evaluations_,
+                this->collapsed_changes_, this->skipped_evaluations_);
+  #ifdef USE_REACTIVE_TEMPLATE_PROFILING
+  if (this->profiling_) {
+    ESP_LOGCONFIG(tag, "  Suppressed: %u", this->get_suppressed_count());
+    ESP_LOGCONFIG(tag, "  Execution time: min %.0f us, avg %.1f us, max %.0f us", this->get_min_time_us(),
+                  this->get_avg_time_us(), this->get_max_time_us());
+  }
+  #endif
+}
+
+void ReactiveNode::flush_() {
+  this->dirty_ = false;
+  if (this->pending_changes_ > 1) {
+    this->collapsed_changes_ += this->pending_changes_ - 1;
+  }
+  this->pending_changes_ = 0;
+
+  if (this->memoize_ && this->input_bits_ != nullptr) {
+    const size_t size = this->input_count_ * sizeof(uint32_t);
+    if (this->has_evaluated_ && memcmp(this->input_bits_, this->evaluated_bits_, size) == 0) {
+      this->skipped_evaluations_++;
+      return;
+    }
+    memcpy(this->evaluated_bits_, this->input_bits_, size);
+    this->has_evaluated_ = true;
+  }
+  this->evaluations_++;
+  #ifdef USE_REACTIVE_TEMPLATE_PROFILING
+  if (this->profiling_) {
+    const uint32_t start = micros();
+    this->evaluate();
+    const uint32_t elapsed = micros() - start;
+    this->time_total_us_ += elapsed;
+    if (elapsed < this->time_min_us_) {
+      this->time_min_us_ = elapsed;
+    }
+    if (elapsed > this->time_max_us_) {
+      this->time_max_us_ = elapsed;
+    }
+    return;
+  }
+  #endif
+  this->evaluate();
+}
+
+void ReactiveNode::input_changed_(uint8_t slot, uint32_t bits, bool valid) {
+  if (this->input_bits_ != nullptr) {
+    this->input_bits_[slot] = bits;
+  }
+  this->set_input_valid_(slot, valid);
+  if (this->invalid_inputs_ != 0) {
+    this->dirty_ = false;
+    this->pending_ = false;
+    this->pending_changes_ = 0;
+    // the output is invalidated, evaluate again even for the same inputs
+    this->has_evaluated_ = false;
+    this->on_invalid_inputs_();
+    return;
+  }
+  this->pending_changes_++;
+
+  const uint32_t now = millis();
+  switch (this->strategy_) {
+    case REACTIVE_IMMEDIATE:
+      this->mark_dirty();
+      break;
+    case REACTIVE_LEADING:
+      if (!this->window_open_) {
+        this->window_open_ = true;
+        this->mark_dirty();
+      }
+      // the window closes only after a quiet period
+      this->arm_(now);
+      break;
+    case REACTIVE_TRAILING:
+      this->pending_ = true;
+      this->arm_(now);
+      break;
+    case REACTIVE_THROTTLE:
+      if (!this->window_open_) {
+        this->window_open_ = true;
+        this->mark_dirty();
+        this->arm_(now);
+      } else {
+        // picked up when the window ends, keeps the publish rate bounded
+        this->pending_ = true;
+      }
+      break;
+  }
+}
+
+void ReactiveNode::arm_(uint32_t now) {
+  this->deadline_ms_ = now + this->window_ms_;
+  if (!this->armed_) {
+    this->armed_ = true;
+    if (this->engine_ != nullptr) {
+      this->engine_->watch_deadline();
+    }
+  }
+}
+
+void ReactiveNode::on_deadline_(uint32_t now) {
+  this->armed_ = false;
+  switch (this->strategy_) {
+    case REACTIVE_TRAILING:
+      if (this->pending_) {
+        this->pending_ = false;
+        this->mark_dirty();
+      }
+      break;
+    case REACTIVE_THROTTLE:
+      if (this->pending_) {
+        // evaluate now and open the next window
+        this->pending_ = false;
+        this->mark_dirty();
+        this->arm_(now);
+      } else {
+        this->window_open_ = false;
+      }
+      break;
+    default:
+      // leading: changes inside the window were covered by its first evaluation
+      this->collapsed_changes_ += this->pending_changes_;
+      this->pending_changes_ = 0;
+      this->window_open_ = false;
+      break;
+  }
+}
+
+void ReactiveEngine::add_node(ReactiveNode *node) {
+  node->engine_ = this;
+  node->index_ = this->nodes_.size();
+  this->nodes_.push_back(node);
+}
+
+void ReactiveEngine::setup() {
+  // inputs may have been published before setup, keep looping for them
+  for (auto *node : this->nodes_) {
+    if (node->dirty_) {
+      this->scheduled_ = true;
+    }
+  }
+  if (!this->scheduled_ && this->armed_count_ == 0) {
+    this->disable_loop();
+  }
+}
+
+void ReactiveEngine::dump_config() {
+  ESP_LOGCONFIG(TAG, "Reactive Template Engine:");
+  ESP_LOGCONFIG(TAG, "  Nodes: %u", (unsigned) this->nodes_.size());
+}
+
+void ReactiveEngine::schedule(ReactiveNode *node) {
+  // a node later in the order is still reached by the running flush
+  if (this->flushing_ && node->index_ > this->position_) {
+    return;
+  }
+  if (!this->scheduled_) {
+    this->scheduled_ = true;
+    this->enable_loop();
+  }
+}
+
+void ReactiveEngine::loop() {
+  // expired deadlines mark their nodes dirty and are flushed in this pass
+  if (this->armed_count_ != 0) {
+    const uint32_t now = millis();
+    for (auto *node : this->nodes_) {
+      if (node->armed_ && (int32_t) (now - node->deadline_ms_) >= 0) {
+        this->armed_count_--;
+        node->on_deadline_(now);
+      }
+    }
+  }
+
+  this->scheduled_ = false;
+  this->flushing_ = true;
+  for (this->position_ = 0; this->position_ < this->nodes_.size(); this->position_++) {
+    auto *node = this->nodes_[this->position_];
+    if (node->dirty_) {
+      node->flush_();
+    }
+  }
+  this->flushing_ = false;
+
+  // only feedback through non-reactive entities can leave work for the next loop
+  if (!this->scheduled_ && this->armed_count_ == 0) {
+    this->disable_loop();
+  }
+}
+
+}  // namespace reactive_template_
+}  // namespace esphome
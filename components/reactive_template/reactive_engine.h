@@ -0,0 +1,185 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include <array>
+#include <cstring>
+#include <vector>
+
+namespace esphome {
+namespace reactive_template_ {
+
+class ReactiveEngine;
+
+enum ReactiveStrategy : uint8_t {
+  // evaluate in the next flush after every change
+  REACTIVE_IMMEDIATE,
+  // evaluate on the first change, ignore changes until inputs were quiet for the window
+  REACTIVE_LEADING,
+  // evaluate once inputs were quiet for the window
+  REACTIVE_TRAILING,
+  // evaluate on the first change, then at most once per window with the latest inputs
+  REACTIVE_THROTTLE,
+};
+
+inline const char *reactive_strategy_to_str(ReactiveStrategy strategy) {
+  switch (strategy) {
+    case REACTIVE_IMMEDIATE: return "immediate";
+    case REACTIVE_LEADING: return "leading";
+    case REACTIVE_TRAILING: return "trailing";
+    case REACTIVE_THROTTLE: return "throttle";
+    default: return "unknown";
+  }
+}
+
+// A reactive template that is re-evaluated by the engine once its inputs changed.
+class ReactiveNode {
+ public:
+  // the evaluation itself happens in the next flush
+  void mark_dirty();
+  void clear_dirty() { this->dirty_ = false; }
+
+  virtual void evaluate() = 0;
+
+  void set_strategy(ReactiveStrategy strategy, uint32_t window_ms) {
+    this->strategy_ = strategy;
+    this->window_ms_ = window_ms;
+  }
+  // skip the evaluation when all inputs are bit-identical to the last one
+  void set_memoize(bool memoize) { this->memoize_ = memoize; }
+
+  // logs strategy and counters, for dump_config() of the node
+  void dump_reactive_config(const char *tag) const;
+
+  uint32_t get_evaluations() const { return this->evaluations_; }
+  // input changes that were folded into an evaluation of a later change
+  uint32_t get_collapsed_changes() const { return this->collapsed_changes_; }
+  // flushes that found the inputs unchanged and did not evaluate
+  uint32_t get_skipped_evaluations() const { return this->skipped_evaluations_; }
+  // evaluations or results that were dropped, nodes add their own reasons
+  virtual uint32_t get_suppressed_count() const { return this->skipped_evaluations_; }
+
+  #ifdef USE_REACTIVE_TEMPLATE_PROFILING
+  void enable_profiling() { this->profiling_ = true; }
+  // execution time of evaluate() in µs, NAN before the first evaluation
+  float get_min_time_us() const { return this->evaluations_ == 0 ? NAN : this->time_min_us_; }
+  float get_avg_time_us() const { return this->evaluations_ == 0 ? NAN : (float) this->time_total_us_ / this->evaluations_; }
+  float get_max_time_us() const { return this->evaluations_ == 0 ? NAN : this->time_max_us_; }
+  #endif
+
+  static const uint8_t MAX_INPUTS = 32;
+
+ protected:
+  friend class ReactiveEngine;
+
+  // registers one more input, returns its slot for input_changed_()
+  uint8_t add_input_(uint32_t bits, bool valid) {
+    const uint8_t slot = this->input_count_++;
+    if (this->input_bits_ != nullptr) {
+      this->input_bits_[slot] = bits;
+    }
+    this->set_input_valid_(slot, valid);
+    return slot;
+  }
+  // one word per input for memoization, owned by the node type that knows its
+  // input count; nodes without storage always evaluate
+  void set_input_storage_(uint32_t *input_bits, uint32_t *evaluated_bits) {
+    this->input_bits_ = input_bits;
+    this->evaluated_bits_ = evaluated_bits;
+  }
+  // bits is the raw input value, compared bitwise for memoization
+  void input_changed_(uint8_t slot, uint32_t bits, bool valid);
+  static uint32_t float_bits_(float value) {
+    uint32_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+  }
+  void set_input_valid_(uint8_t slot, bool valid) {
+    if (valid) {
+      this->invalid_inputs_ &= ~(1UL << slot);
+    } else {
+      this->invalid_inputs_ |= 1UL << slot;
+    }
+  }
+  // some input is NAN, evaluation is held back until all are valid again
+  virtual void on_invalid_inputs_() {}
+
+  void flush_();
+
+  void arm_(uint32_t now);
+  // called by the engine once deadline_ms_ passed
+  void on_deadline_(uint32_t now);
+
+  ReactiveEngine *engine_{nullptr};
+  // position in the topological order
+  uint16_t index_{0};
+  bool dirty_{false};
+  uint8_t input_count_{0};
+  // bit per input slot, set while that input is NAN
+  uint32_t invalid_inputs_{0};
+  uint32_t pending_changes_{0};
+  uint32_t collapsed_changes_{0};
+  uint32_t evaluations_{0};
+  uint32_t skipped_evaluations_{0};
+
+  #ifdef USE_REACTIVE_TEMPLATE_PROFILING
+  bool profiling_{false};
+  uint32_t time_min_us_{UINT32_MAX};
+  uint32_t time_max_us_{0};
+  uint64_t time_total_us_{0};
+  #endif
+
+  bool memoize_{true};
+  // evaluated_bits_ holds the inputs of a valid evaluation
+  bool has_evaluated_{false};
+  // latest value of every input and the values the last evaluation saw
+  uint32_t *input_bits_{nullptr};
+  uint32_t *evaluated_bits_{nullptr};
+
+  ReactiveStrategy strategy_{REACTIVE_IMMEDIATE};
+  uint32_t window_ms_{0};
+  uint32_t deadline_ms_{0};
+  // deadline_ms_ is being watched by the engine
+  bool armed_{false};
+  // leading/throttle: inside the window opened by an evaluation
+  bool window_open_{false};
+  // trailing/throttle: a change is waiting for the deadline
+  bool pending_{false};
+};
+
+// Memoization storage for a node with N inputs, sized at compile time.
+template<size_t N> class ReactiveInputs {
+ protected:
+  std::array<uint32_t, N> input_storage_{};
+  std::array<uint32_t, N> evaluated_storage_{};
+};
+
+// Evaluates all dirty nodes once per loop. Nodes are added in topological order
+// (generated at codegen), so a node always runs after every reactive node it
+// reads from and sees their new values within the same flush. Debounce and
+// throttle deadlines of all nodes are checked here too, no scheduler timeouts.
+class ReactiveEngine : public Component {
+ public:
+  void add_node(ReactiveNode *node);
+
+  void setup() override;
+  void loop() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void schedule(ReactiveNode *node);
+  void watch_deadline() {
+    this->armed_count_++;
+    this->enable_loop();
+  }
+
+ protected:
+  std::vector<ReactiveNode *> nodes_;
+  bool scheduled_{false};
+  bool flushing_{false};
+  uint16_t position_{0};
+  // nodes with a deadline, the loop keeps running while there are any
+  uint16_t armed_count_{0};
+};
+
+}  // namespace reactive_template_
+}  // namespace esphome
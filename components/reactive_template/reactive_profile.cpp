@@ -0,0 +1,29 @@
+#include "reactive_profile.h"
+
+#ifdef USE_REACTIVE_TEMPLATE_PROFILING
+
+namespace esphome {
+namespace reactive_template_ {
+
+void ReactiveProfile::update() {
+  if (this->evaluations_sensor_ != nullptr) {
+    this->evaluations_sensor_->publish_state(this->node_->get_evaluations());
+  }
+  if (this->suppressed_sensor_ != nullptr) {
+    this->suppressed_sensor_->publish_state(this->node_->get_suppressed_count());
+  }
+  if (this->min_time_sensor_ != nullptr) {
+    this->min_time_sensor_->publish_state(this->node_->get_min_time_us());
+  }
+  if (this->avg_time_sensor_ != nullptr) {
+    this->avg_time_sensor_->publish_state(this->node_->get_avg_time_us());
+  }
+  if (this->max_time_sensor_ != nullptr) {
+    this->max_time_sensor_->publish_state(this->node_->get_max_time_us());
+  }
+}
+
+}  // namespace reactive_template_
+}  // namespace esphome
+
+#endif
@@ -0,0 +1,41 @@
+#pragma once
+
+#ifdef USE_REACTIVE_TEMPLATE_PROFILING
+
+#include "esphome/core/component.h"
+#include "esphome/components/sensor/sensor.h"
+#include "reactive_engine.h"
+
+namespace esphome {
+namespace reactive_template_ {
+
+// Publishes the profiling counters of one reactive node as diagnostic sensors.
+class ReactiveProfile : public PollingComponent {
+ public:
+  void set_node(ReactiveNode *node) {
+    this->node_ = node;
+    node->enable_profiling();
+  }
+
+  void set_evaluations_sensor(sensor::Sensor *sensor) { this->evaluations_sensor_ = sensor; }
+  void set_suppressed_sensor(sensor::Sensor *sensor) { this->suppressed_sensor_ = sensor; }
+  void set_min_time_sensor(sensor::Sensor *sensor) { this->min_time_sensor_ = sensor; }
+  void set_avg_time_sensor(sensor::Sensor *sensor) { this->avg_time_sensor_ = sensor; }
+  void set_max_time_sensor(sensor::Sensor *sensor) { this->max_time_sensor_ = sensor; }
+
+  void update() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+ protected:
+  ReactiveNode *node_{nullptr};
+  sensor::Sensor *evaluations_sensor_{nullptr};
+  sensor::Sensor *suppressed_sensor_{nullptr};
+  sensor::Sensor *min_time_sensor_{nullptr};
+  sensor::Sensor *avg_time_sensor_{nullptr};
+  sensor::Sensor *max_time_sensor_{nullptr};
+};
+
+}  // namespace reactive_template_
+}  // namespace esphome
+
+#endif
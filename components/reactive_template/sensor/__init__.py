@@ -5,7 +5,13 @@ import esphome.config_validation as cv
 from esphome.core import ID
 from esphome.const import CONF_ID, CONF_LAMBDA, CONF_STATE
 
-from .. import template_ns
+from .. import (
+    template_ns,
+    setup_reactive_node,
+    new_lambda_node,
+    REACTIVE_SCHEMA,
+    MAX_INPUTS,
+)
 
 def toIDs(sensor):
     return f"{sensor.id}"
@@ -13,33 +19,104 @@ def toIDs(sensor):
 ReactiveTemplateSensor = template_ns.class_(
     "ReactiveTemplateSensor", sensor.Sensor, cg.Component
 )
+# ReactiveLambdaSensor<function, inputs>, declared per sensor with a lambda
+ReactiveLambdaSensor = template_ns.class_(
+    "ReactiveLambdaSensor", ReactiveTemplateSensor
+)
+ReactiveAggregateSensor = template_ns.class_(
+    "ReactiveAggregateSensor", ReactiveTemplateSensor
+)
+AggregateType = template_ns.enum("AggregateType")
+AGGREGATE_TYPES = {
+    "mean": AggregateType.AGGREGATE_MEAN,
+    "min": AggregateType.AGGREGATE_MIN,
+    "max": AggregateType.AGGREGATE_MAX,
+    "sum": AggregateType.AGGREGATE_SUM,
+    "integral": AggregateType.AGGREGATE_INTEGRAL,
+    "ewma": AggregateType.AGGREGATE_EWMA,
+}
+
 CONF_SENSORS = "depends_on_sensors"
+CONF_DEADBAND = "deadband"
+CONF_AGGREGATE = "aggregate"
+CONF_SOURCE = "source"
+CONF_TYPE = "type"
+CONF_WINDOW = "window"
+CONF_COUNT = "count"
+CONF_BUCKETS = "buckets"
 
 
-CONFIG_SCHEMA = (
+def deadband(value):
+    # "5%" is relative to the last published value, a plain number is absolute
+    if isinstance(value, str) and value.strip().endswith("%"):
+        return {"value": cv.positive_float(value.strip()[:-1]) / 100, "relative": True}
+    return {"value": cv.positive_float(value), "relative": False}
+
+
+TEMPLATE_SCHEMA = (
     sensor.sensor_schema(
         ReactiveTemplateSensor,
         accuracy_decimals=1,
     )
+    .extend(REACTIVE_SCHEMA)
     .extend(
         {
             cv.Optional(CONF_LAMBDA): cv.returning_lambda,
+            cv.Optional(CONF_DEADBAND): deadband,
             # array of sensor_schema
-            cv.Optional(CONF_SENSORS): cv.ensure_list(cv.use_id(cg.EntityBase)),
+            cv.Optional(CONF_SENSORS): cv.All(
+                cv.ensure_list(cv.use_id(cg.EntityBase)), cv.Length(max=MAX_INPUTS)
+            ),
         }
     )
 )
 
+def validate_buckets(config):
+    if CONF_WINDOW in config and config[CONF_WINDOW].total_milliseconds < config[CONF_BUCKETS]:
+        raise cv.Invalid(f"'{CONF_WINDOW}' is too short for {config[CONF_BUCKETS]} buckets")
+    return config
 
-async def to_code(config):
-    var = await sensor.new_sensor(config)
-    await cg.register_component(var, config)
 
-    if CONF_LAMBDA in config:
-        template_ = await cg.process_lambda(
-            config[CONF_LAMBDA], [], return_type=cg.optional.template(float)
-        )
-        cg.add(var.set_template(template_))
+AGGREGATE_SCHEMA = (
+    sensor.sensor_schema(
+        ReactiveAggregateSensor,
+        accuracy_decimals=1,
+    )
+    .extend(REACTIVE_SCHEMA)
+    .extend(
+        {
+            cv.Required(CONF_AGGREGATE): cv.All(
+                cv.Schema(
+                    {
+                        cv.Required(CONF_SOURCE): cv.use_id(sensor.Sensor),
+                        cv.Required(CONF_TYPE): cv.enum(AGGREGATE_TYPES, lower=True),
+                        cv.Exclusive(CONF_WINDOW, "window"): cv.positive_time_period_milliseconds,
+                        cv.Exclusive(CONF_COUNT, "window"): cv.int_range(min=1, max=4096),
+                        # time windows only, memory is one bucket per slice
+                        cv.Optional(CONF_BUCKETS, default=20): cv.int_range(min=1, max=1024),
+                    }
+                ),
+                cv.has_exactly_one_key(CONF_WINDOW, CONF_COUNT),
+                validate_buckets,
+            ),
+            cv.Optional(CONF_DEADBAND): deadband,
+        }
+    )
+)
+
+
+def CONFIG_SCHEMA(config):
+    if isinstance(config, dict) and CONF_AGGREGATE in config:
+        return AGGREGATE_SCHEMA(config)
+    return TEMPLATE_SCHEMA(config)
+
+
+async def to_code(config):
+    if aggregate := config.get(CONF_AGGREGATE):
+        var = await sensor.new_sensor(config)
+        await cg.register_component(var, config)
+        await aggregate_to_code(var, config, aggregate)
+        return
 
     dependsOnSensors = []
 
@@ -48,33 +125,40 @@ async def to_code(config):
     elif CONF_LAMBDA in config:
         dependsOnSensors = config[CONF_LAMBDA].requires_ids
 
-    dependsOnName = f"{config['id'].id}_execute_on_change"
-
-    # expr = cg.RawExpression(f"static sensor::Sensor * const {dependsOnName}[{len(dependsOnSensors)}] = " + "{ " + ",".join(map(toIDs,dependsOnSensors)) + " }")
-    notnull = " && ".join([f"{s.id} != nullptr" for s in dependsOnSensors])
-    sensor_conditions = " && ".join([f"!std::isnan({s.id}->state)" for s in dependsOnSensors])
-
-    expr = cg.RawExpression(f"""
-void {dependsOnName}() {{
-    if ({notnull} && {sensor_conditions}) {{
-        App.scheduler.set_timeout({config['id'].id}, "updateValue", 40, []() {{
-            {config['id'].id}->execute();
-        }});
-    }} else {{
-        if (!std::isnan({config['id'].id}->state)) {{
-            {config['id'].id}->publish_state(NAN);
-        }}
-        App.scheduler.cancel_timeout({config['id'].id}, "updateValue");
-    }}
-}}
-""")
-
-    cg.add_global(expr)
+    if CONF_LAMBDA in config:
+        var = await new_lambda_node(
+            config,
+            ReactiveLambdaSensor,
+            cg.optional.template(float),
+            dependsOnSensors,
+            sensor.new_sensor,
+        )
+    else:
+        var = await sensor.new_sensor(config)
+    await cg.register_component(var, config)
+
+    if band := config.get(CONF_DEADBAND):
+        cg.add(var.set_deadband(band["value"], band["relative"]))
+
     for s in dependsOnSensors:
         sens = await cg.get_variable(s)
-        cg.add(var.add_to_track(sens, cg.RawExpression(f"{dependsOnName}")))
-    
-    # cg.add(var.set_depends_on_sensors(cg.RawExpression(f"{dependsOnName}"), len(dependsOnSensors)));
+        cg.add(var.add_to_track(sens))
+    await setup_reactive_node(var, config, dependsOnSensors)
+
+
+async def aggregate_to_code(var, config, aggregate):
+    source = await cg.get_variable(aggregate[CONF_SOURCE])
+    cg.add(var.set_source(source))
+    cg.add(var.set_type(aggregate[CONF_TYPE]))
+    if CONF_COUNT in aggregate:
+        cg.add(var.set_count_window(aggregate[CONF_COUNT]))
+    else:
+        cg.add(var.set_time_window(aggregate[CONF_WINDOW], aggregate[CONF_BUCKETS]))
+
+    if band := config.get(CONF_DEADBAND):
+        cg.add(var.set_deadband(band["value"], band["relative"]))
+
+    await setup_reactive_node(var, config, [aggregate[CONF_SOURCE]])
 
 
 @automation.register_action(
@@ -0,0 +1,110 @@
+#include "aggregate_sensor.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+#include <cmath>
+
+namespace esphome {
+namespace reactive_template_ {
+
+static const char *const TAG = "reactive.template.aggregate";
+
+static const char *aggregate_type_to_str(AggregateType type) {
+  switch (type) {
+    case AGGREGATE_MEAN: return "mean";
+    case AGGREGATE_MIN: return "min";
+    case AGGREGATE_MAX: return "max";
+    case AGGREGATE_SUM: return "sum";
+    case AGGREGATE_INTEGRAL: return "integral";
+    case AGGREGATE_EWMA: return "ewma";
+    default: return "unknown";
+  }
+}
+
+ReactiveAggregateSensor::ReactiveAggregateSensor() {
+  // the result also changes when old samples expire, not only with the inputs
+  this->memoize_ = false;
+}
+
+void ReactiveAggregateSensor::setup() {
+  ReactiveTemplateSensor::setup();
+  if (this->count_ != 0) {
+    this->window_.init(this->count_);
+  } else {
+    this->window_.init(this->buckets_);
+    this->set_interval("bucket", this->time_window_ms_ / this->buckets_, [this]() {
+      this->window_.close_bucket();
+      this->mark_dirty();
+    });
+  }
+}
+
+void ReactiveAggregateSensor::dump_config() {
+  LOG_SENSOR("", "Reactive Aggregate Sensor", this);
+  if (this->count_ != 0) {
+    ESP_LOGCONFIG(TAG, "  Aggregate: %s of the last %u samples", aggregate_type_to_str(this->type_), this->count_);
+  } else {
+    ESP_LOGCONFIG(TAG, "  Aggregate: %s of the last %u ms in %u buckets", aggregate_type_to_str(this->type_),
+                  this->time_window_ms_, this->buckets_);
+  }
+  this->dump_reactive_config(TAG);
+  ESP_LOGCONFIG(TAG, "  Suppressed publishes: %u", this->suppressed_publishes_);
+}
+
+void ReactiveAggregateSensor::set_source(sensor::Sensor *source) {
+  this->source_ = source;
+  const uint8_t slot = this->add_input_(0, true);
+  source->add_on_state_callback([this, slot](float state) {
+    // a missing sample does not invalidate the window
+    if (std::isnan(state)) {
+      return;
+    }
+    this->add_sample_(state);
+    this->input_changed_(slot, float_bits_(state), true);
+  });
+}
+
+void ReactiveAggregateSensor::add_sample_(float value) {
+  const uint32_t now = millis();
+  const float dt_s = (now - this->last_sample_ms_) / 1000.0f;
+  const bool has_previous = !std::isnan(this->last_sample_);
+
+  switch (this->type_) {
+    case AGGREGATE_EWMA: {
+      if (!has_previous) {
+        this->ewma_ = value;
+        break;
+      }
+      // count windows use the usual 2 / (N + 1), time windows use the window as time constant
+      const float alpha = this->count_ != 0 ? 2.0f / (this->count_ + 1)
+                                            : 1.0f - std::exp(-dt_s * 1000.0f / this->time_window_ms_);
+      this->ewma_ += alpha * (value - this->ewma_);
+      break;
+    }
+    default: {
+      // trapezoid between this sample and the previous one
+      const float area = has_previous ? (value + this->last_sample_) * 0.5f * dt_s : 0.0f;
+      this->window_.add(value, area);
+      if (this->count_ != 0) {
+        this->window_.close_bucket();
+      }
+      break;
+    }
+  }
+  this->last_sample_ = value;
+  this->last_sample_ms_ = now;
+}
+
+float ReactiveAggregateSensor::value_() {
+  switch (this->type_) {
+    case AGGREGATE_MEAN: return this->window_.mean();
+    case AGGREGATE_MIN: return this->window_.min();
+    case AGGREGATE_MAX: return this->window_.max();
+    case AGGREGATE_SUM: return this->window_.sum();
+    case AGGREGATE_INTEGRAL: return this->window_.integral();
+    case AGGREGATE_EWMA: return this->ewma_;
+    default: return NAN;
+  }
+}
+
+}  // namespace reactive_template_
+}  // namespace esphome
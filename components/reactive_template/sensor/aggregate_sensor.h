@@ -0,0 +1,47 @@
+#pragma once
+
+#include "template_sensor.h"
+#include "../aggregate.h"
+
+namespace esphome {
+namespace reactive_template_ {
+
+// Aggregate of one source sensor over a count or time window. Every source
+// sample is folded in O(1) as it arrives, the engine only publishes the result,
+// so strategies and deadband of reactive templates apply to the output.
+class ReactiveAggregateSensor : public ReactiveTemplateSensor {
+ public:
+  ReactiveAggregateSensor();
+
+  void setup() override;
+  void dump_config() override;
+  void evaluate() override { this->publish_result_(this->value_()); }
+
+  void set_source(sensor::Sensor *source);
+  void set_type(AggregateType type) { this->type_ = type; }
+  // the last `count` samples
+  void set_count_window(uint16_t count) { this->count_ = count; }
+  // the last `window_ms`, kept as `buckets` slices; the oldest slice expires as a whole
+  void set_time_window(uint32_t window_ms, uint16_t buckets) {
+    this->time_window_ms_ = window_ms;
+    this->buckets_ = buckets;
+  }
+
+ protected:
+  void add_sample_(float value);
+  float value_();
+
+  sensor::Sensor *source_{nullptr};
+  AggregateType type_{AGGREGATE_MEAN};
+  uint16_t count_{0};
+  uint32_t time_window_ms_{0};
+  uint16_t buckets_{0};
+
+  SlidingAggregate window_;
+  float ewma_{NAN};
+  float last_sample_{NAN};
+  uint32_t last_sample_ms_{0};
+};
+
+}  // namespace reactive_template_
+}  // namespace esphome
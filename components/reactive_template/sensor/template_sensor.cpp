@@ -12,35 +12,60 @@ void ReactiveTemplateSensor::setup() {
 }
 
 float ReactiveTemplateSensor::get_setup_priority() const { return setup_priority::DATA; }
-void ReactiveTemplateSensor::set_template(std::function<optional<float>()> &&f) { this->f_ = f; }
 void ReactiveTemplateSensor::dump_config() {
   LOG_SENSOR("", "Reactive Template Sensor", this);
+  if (this->deadband_ > 0) {
+    ESP_LOGCONFIG(TAG, "  Deadband: %g%s", this->deadband_relative_ ? this->deadband_ * 100 : this->deadband_,
+                  this->deadband_relative_ ? "%" : "");
+  }
+  this->dump_reactive_config(TAG);
+  ESP_LOGCONFIG(TAG, "  Suppressed publishes: %u", this->suppressed_publishes_);
 }
 
-void ReactiveTemplateSensor::execute() {
-  #ifdef ESPHOME_LOG_HAS_WARN
-  if (this->f_ == nullptr) {
-    ESP_LOGW(TAG, "No template function set for Reactive Template Sensor '%s'", this->get_name().c_str());
+void ReactiveTemplateSensor::publish_result_(optional<float> val) {
+  if (!val.has_value()) {
+    return;
+  }
+  if (!this->get_force_update() && !this->exceeds_deadband_(*val)) {
+    this->suppressed_publishes_++;
     return;
   }
-  #endif
-  
-  auto val = (this->f_)();
-  if (val.has_value()) {
-    this->publish_state(*val);
+  this->last_value_ = *val;
+  this->publish_state(*val);
+}
+
+bool ReactiveTemplateSensor::exceeds_deadband_(float value) const {
+  if (std::isnan(value) || std::isnan(this->last_value_)) {
+    return std::isnan(value) != std::isnan(this->last_value_);
+  }
+  const float delta = std::fabs(value - this->last_value_);
+  if (delta == 0) {
+    return false;
+  }
+  const float deadband = this->deadband_relative_ ? this->deadband_ * std::fabs(this->last_value_) : this->deadband_;
+  return delta > deadband;
+}
+
+void ReactiveTemplateSensor::on_invalid_inputs_() {
+  if (!std::isnan(this->state)) {
+    this->last_value_ = NAN;
+    this->publish_state(NAN);
   }
 }
 
-void ReactiveTemplateSensor::add_to_track(sensor::Sensor *sensor_to_add, std::function<void()> &&callback) {
-  sensor_to_add->add_on_state_callback([callback](float state) {
-    callback();
+void ReactiveTemplateSensor::add_to_track(sensor::Sensor *sensor_to_add) {
+  const float state = sensor_to_add->state;
+  const uint8_t slot = this->add_input_(float_bits_(state), !std::isnan(state));
+  sensor_to_add->add_on_state_callback([this, slot](float state) {
+    this->input_changed_(slot, float_bits_(state), !std::isnan(state));
   });
 }
 
 #ifdef USE_BINARY_SENSOR
-void ReactiveTemplateSensor::add_to_track(binary_sensor::BinarySensor *sensor_to_add, std::function<void()> &&callback) {
-  sensor_to_add->add_on_state_callback([callback](bool state) {
-    callback();
+void ReactiveTemplateSensor::add_to_track(binary_sensor::BinarySensor *sensor_to_add) {
+  const uint8_t slot = this->add_input_(sensor_to_add->state, true);
+  sensor_to_add->add_on_state_callback([this, slot](bool state) {
+    this->input_changed_(slot, state, true);
   });
 }
 #endif
@@ -5,29 +5,58 @@
 #ifdef USE_BINARY_SENSOR
   #include "esphome/components/binary_sensor/binary_sensor.h"
 #endif
+#include "../reactive_engine.h"
 
 namespace esphome {
 namespace reactive_template_ {
 
-class ReactiveTemplateSensor : public sensor::Sensor, public Component {
+// Reactive sensor without a lambda of its own, published by actions only.
+// Sensors with a lambda are ReactiveLambdaSensor, generated per configuration.
+class ReactiveTemplateSensor : public sensor::Sensor, public Component, public ReactiveNode {
  public:
-  void set_template(std::function<optional<float>()> &&f);
-
   void setup() override;
 
   void dump_config() override;
 
   float get_setup_priority() const override;
 
-  void add_to_track(sensor::Sensor *sensor_to_add, std::function<void(void)> &&callback );
+  void add_to_track(sensor::Sensor *sensor_to_add);
   #ifdef USE_BINARY_SENSOR
-  void add_to_track(binary_sensor::BinarySensor *sensor_to_add, std::function<void(void)> &&callback);
+  void add_to_track(binary_sensor::BinarySensor *sensor_to_add);
   #endif
 
-  void execute();
+  // evaluates right away, bypassing the engine
+  void execute() { this->evaluate(); }
+  void evaluate() override {}
+
+  // results within the deadband of the last published value are not published,
+  // relative deadbands are a fraction of that value
+  void set_deadband(float deadband, bool relative) {
+    this->deadband_ = deadband;
+    this->deadband_relative_ = relative;
+  }
+  uint32_t get_suppressed_publishes() const { return this->suppressed_publishes_; }
+  uint32_t get_suppressed_count() const override { return this->skipped_evaluations_ + this->suppressed_publishes_; }
+
  protected:
-  std::function<optional<float>()> f_{nullptr};
-  uint8_t dependsOnCount;
+  void publish_result_(optional<float> val);
+  void on_invalid_inputs_() override;
+  bool exceeds_deadband_(float value) const;
+
+  float deadband_{0};
+  bool deadband_relative_{false};
+  float last_value_{NAN};
+  uint32_t suppressed_publishes_{0};
+};
+
+// F is the configured lambda as a free function, so the evaluation calls it
+// directly and can inline it. N is the number of add_to_track() inputs.
+template<optional<float> (*F)(), size_t N>
+class ReactiveLambdaSensor : public ReactiveTemplateSensor, protected ReactiveInputs<N> {
+ public:
+  ReactiveLambdaSensor() { this->set_input_storage_(this->input_storage_.data(), this->evaluated_storage_.data()); }
+
+  void evaluate() override { this->publish_result_(F()); }
 };
 
 }  // namespace reactive_template_
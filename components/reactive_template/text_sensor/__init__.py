@@ -0,0 +1,46 @@
+import esphome.codegen as cg
+from esphome.components import text_sensor
+import esphome.config_validation as cv
+from esphome.const import CONF_LAMBDA
+
+from .. import template_ns, setup_reactive_node, new_lambda_node, REACTIVE_SCHEMA
+
+ReactiveTemplateTextSensor = template_ns.class_(
+    "ReactiveTemplateTextSensor", text_sensor.TextSensor, cg.Component
+)
+# ReactiveLambdaTextSensor<function, inputs>, declared per text sensor with a lambda
+ReactiveLambdaTextSensor = template_ns.class_(
+    "ReactiveLambdaTextSensor", ReactiveTemplateTextSensor
+)
+
+CONFIG_SCHEMA = (
+    text_sensor.text_sensor_schema(ReactiveTemplateTextSensor)
+    .extend(
+        {
+            cv.Optional(CONF_LAMBDA): cv.returning_lambda,
+        }
+    )
+    .extend(REACTIVE_SCHEMA)
+    .extend(cv.COMPONENT_SCHEMA)
+)
+
+
+async def to_code(config):
+    depends_on = []
+    if lamb := config.get(CONF_LAMBDA):
+        depends_on = lamb.requires_ids
+        var = await new_lambda_node(
+            config,
+            ReactiveLambdaTextSensor,
+            cg.optional.template(cg.std_string),
+            depends_on,
+            text_sensor.new_text_sensor,
+        )
+    else:
+        var = await text_sensor.new_text_sensor(config)
+    await cg.register_component(var, config)
+
+    for s in depends_on:
+        sens = await cg.get_variable(s)
+        cg.add(var.add_to_track(sens))
+    await setup_reactive_node(var, config, depends_on)
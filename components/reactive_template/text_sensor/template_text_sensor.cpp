@@ -0,0 +1,64 @@
+#include "template_text_sensor.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace reactive_template_ {
+
+static const char *const TAG = "reactive.template.text_sensor";
+
+void ReactiveTemplateTextSensor::setup() {
+  this->disable_loop();
+}
+
+void ReactiveTemplateTextSensor::dump_config() {
+  LOG_TEXT_SENSOR("", "Reactive Template Text Sensor", this);
+  this->dump_reactive_config(TAG);
+  ESP_LOGCONFIG(TAG, "  Suppressed publishes: %u", this->suppressed_publishes_);
+}
+
+void ReactiveTemplateTextSensor::publish_result_(optional<std::string> val) {
+  if (!val.has_value()) {
+    return;
+  }
+  if (this->has_state() && *val == this->state) {
+    this->suppressed_publishes_++;
+    return;
+  }
+  this->publish_state(*val);
+}
+
+void ReactiveTemplateTextSensor::add_to_track(text_sensor::TextSensor *sensor_to_add) {
+  // texts don't fit the input word: it counts the changes, found by comparing
+  // with a copy of the last text, so memoization never mistakes two texts
+  const uint8_t slot = this->add_input_(0, true);
+  sensor_to_add->add_on_state_callback(
+      [this, slot, last = sensor_to_add->state, changes = uint32_t(0)](const std::string &state) mutable {
+        if (state != last) {
+          last = state;
+          changes++;
+        }
+        this->input_changed_(slot, changes, true);
+      });
+}
+
+#ifdef USE_SENSOR
+void ReactiveTemplateTextSensor::add_to_track(sensor::Sensor *sensor_to_add) {
+  // the lambda renders NAN inputs itself, e.g. as "unknown"
+  const uint8_t slot = this->add_input_(float_bits_(sensor_to_add->state), true);
+  sensor_to_add->add_on_state_callback([this, slot](float state) {
+    this->input_changed_(slot, float_bits_(state), true);
+  });
+}
+#endif
+
+#ifdef USE_BINARY_SENSOR
+void ReactiveTemplateTextSensor::add_to_track(binary_sensor::BinarySensor *sensor_to_add) {
+  const uint8_t slot = this->add_input_(sensor_to_add->state, true);
+  sensor_to_add->add_on_state_callback([this, slot](bool state) {
+    this->input_changed_(slot, state, true);
+  });
+}
+#endif
+
+}  // namespace reactive_template_
+}  // namespace esphome
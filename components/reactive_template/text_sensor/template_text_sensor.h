@@ -0,0 +1,56 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/text_sensor/text_sensor.h"
+#ifdef USE_SENSOR
+  #include "esphome/components/sensor/sensor.h"
+#endif
+#ifdef USE_BINARY_SENSOR
+  #include "esphome/components/binary_sensor/binary_sensor.h"
+#endif
+#include "../reactive_engine.h"
+
+namespace esphome {
+namespace reactive_template_ {
+
+// Reactive text sensor without a lambda of its own, published by actions only.
+// Text sensors with a lambda are ReactiveLambdaTextSensor.
+class ReactiveTemplateTextSensor : public text_sensor::TextSensor, public Component, public ReactiveNode {
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::DATA; }
+
+  void add_to_track(text_sensor::TextSensor *sensor_to_add);
+  #ifdef USE_SENSOR
+  void add_to_track(sensor::Sensor *sensor_to_add);
+  #endif
+  #ifdef USE_BINARY_SENSOR
+  void add_to_track(binary_sensor::BinarySensor *sensor_to_add);
+  #endif
+
+  void evaluate() override {}
+
+  uint32_t get_suppressed_count() const override { return this->skipped_evaluations_ + this->suppressed_publishes_; }
+
+ protected:
+  // a result equal to the published text is dropped
+  void publish_result_(optional<std::string> val);
+
+  uint32_t suppressed_publishes_{0};
+};
+
+// F is the configured lambda as a free function, called directly.
+// N is the number of add_to_track() inputs.
+template<optional<std::string> (*F)(), size_t N>
+class ReactiveLambdaTextSensor : public ReactiveTemplateTextSensor, protected ReactiveInputs<N> {
+ public:
+  ReactiveLambdaTextSensor() {
+    this->set_input_storage_(this->input_storage_.data(), this->evaluated_storage_.data());
+  }
+
+  void evaluate() override { this->publish_result_(F()); }
+};
+
+}  // namespace reactive_template_
+}  // namespace esphome
@@ -0,0 +1,132 @@
+// Checks the sliding window of the reactive aggregate sensor against a
+// brute-force window over the same samples.
+#include "reactive_template/aggregate.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <vector>
+
+namespace esphome {
+namespace host_sim {
+
+using reactive_template_::SlidingAggregate;
+
+// the last `capacity` closed buckets plus the open one, every sample kept
+class ReferenceWindow {
+ public:
+  explicit ReferenceWindow(uint16_t capacity) : capacity_(capacity) {}
+
+  void add(float value) { this->open_.push_back(value); }
+  void close_bucket() {
+    this->closed_.push_back(this->open_);
+    if (this->closed_.size() > this->capacity_) {
+      this->closed_.pop_front();
+    }
+    this->open_.clear();
+  }
+
+  std::vector<float> samples() const {
+    std::vector<float> all;
+    for (const auto &bucket : this->closed_) {
+      all.insert(all.end(), bucket.begin(), bucket.end());
+    }
+    all.insert(all.end(), this->open_.begin(), this->open_.end());
+    return all;
+  }
+
+ protected:
+  uint16_t capacity_;
+  std::deque<std::vector<float>> closed_;
+  std::vector<float> open_;
+};
+
+static unsigned failures = 0;
+
+static bool near(float actual, float expected) {
+  if (std::isnan(expected)) {
+    return std::isnan(actual);
+  }
+  return std::fabs(actual - expected) <= 1e-4f * std::fmax(1.0f, std::fabs(expected));
+}
+
+static void compare(const char *name, uint16_t capacity, unsigned step, SlidingAggregate &window,
+                    const ReferenceWindow &reference) {
+  const std::vector<float> samples = reference.samples();
+  float min = NAN, max = NAN, mean = NAN;
+  double sum = 0;
+  for (float value : samples) {
+    min = std::isnan(min) ? value : std::fmin(min, value);
+    max = std::isnan(max) ? value : std::fmax(max, value);
+    sum += value;
+  }
+  if (!samples.empty()) {
+    mean = sum / samples.size();
+  }
+  if (window.count() != samples.size() || !near(window.min(), min) || !near(window.max(), max) ||
+      !near(window.mean(), mean) || !near(window.sum(), samples.empty() ? 0 : sum) ||
+      !near(window.integral(), samples.empty() ? 0 : sum)) {
+    if (failures++ < 10) {
+      printf("FAIL: %s, capacity %u, step %u: count %u/%zu min %g/%g max %g/%g mean %g/%g\n", name, capacity,
+             step, window.count(), samples.size(), window.min(), min, window.max(), max, window.mean(), mean);
+    }
+  }
+}
+
+// count windows close a bucket per sample, time windows every `per_bucket`
+// samples; a negative `per_bucket` leaves every other bucket empty
+static void run(const char *name, float (*sequence)(unsigned), uint16_t capacity, int per_bucket) {
+  SlidingAggregate window;
+  window.init(capacity);
+  ReferenceWindow reference(capacity);
+  const unsigned bucket_samples = std::abs(per_bucket);
+  unsigned buckets = 0;
+  for (unsigned i = 0; i < 2000; i++) {
+    const float value = sequence(i);
+    // the area is the value itself, so the integral has to follow the sum
+    window.add(value, value);
+    reference.add(value);
+    if ((i + 1) % bucket_samples == 0) {
+      window.close_bucket();
+      reference.close_bucket();
+      if (per_bucket < 0 && buckets++ % 2 == 0) {
+        window.close_bucket();
+        reference.close_bucket();
+      }
+    }
+    compare(name, capacity, i, window, reference);
+  }
+}
+
+static float rising(unsigned i) { return i * 0.5f; }
+static float falling(unsigned i) { return 1000.0f - i * 0.5f; }
+static float constant(unsigned i) { return 3.3f; }
+static float sawtooth(unsigned i) { return float(i % 7) - float(i % 3); }
+static float noise(unsigned i) { return float((i * 2654435761u) >> 20) / 64.0f - 32.0f; }
+
+static int run_all() {
+  static const struct {
+    const char *name;
+    float (*sequence)(unsigned);
+  } SEQUENCES[] = {
+      {"rising", rising}, {"falling", falling}, {"constant", constant}, {"sawtooth", sawtooth}, {"noise", noise},
+  };
+  static const uint16_t CAPACITIES[] = {1, 2, 3, 4, 7, 16, 60};
+  // 1 is a count window, the others time windows with several samples per bucket
+  static const int PER_BUCKET[] = {1, 3, 10, -1, -4};
+
+  for (const auto &sequence : SEQUENCES) {
+    for (uint16_t capacity : CAPACITIES) {
+      for (int per_bucket : PER_BUCKET) {
+        run(sequence.name, sequence.sequence, capacity, per_bucket);
+      }
+    }
+  }
+  printf(failures == 0 ? "PASS\n" : "FAILED\n");
+  return failures == 0 ? 0 : 1;
+}
+
+}  // namespace host_sim
+}  // namespace esphome
+
+int main() { return esphome::host_sim::run_all(); }
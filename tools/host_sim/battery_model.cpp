@@ -0,0 +1,44 @@
+#include "battery_model.h"
+#include <algorithm>
+#include <cmath>
+
+namespace esphome {
+namespace host_sim {
+
+float BatteryModel::get_ocv() const {
+  const auto &c = this->config_;
+  float cell_v = c.empty_cell_v + (c.full_cell_v - c.empty_cell_v) * this->soc_;
+  if (this->soc_ > c.tail_soc) {
+    const float x = (this->soc_ - c.tail_soc) / (1.0f - c.tail_soc);
+    cell_v += (c.tail_cell_v - c.full_cell_v) * x * x * x * x;
+  }
+  return cell_v * c.cells;
+}
+
+void BatteryModel::step(float dt_s) {
+  const float ocv = this->get_ocv();
+  const float r = this->config_.internal_resistance_ohm;
+  const float load = this->load_connected_ ? this->load_a_ : 0.0f;
+
+  float charger_a = 0;
+  if (this->mains_ && this->target_v_ > 0) {
+    // enough current to hold the target at the terminals, the source cannot sink
+    charger_a = (this->target_v_ - ocv) / r + load;
+    charger_a = std::max(0.0f, std::min(charger_a, this->current_limit_a_));
+  }
+  this->current_a_ = charger_a - load;
+  this->voltage_v_ = ocv + this->current_a_ * r;
+
+  // charge past 100 % is gassing, it does not add to the state of charge
+  this->soc_ += this->current_a_ * dt_s / 3600.0f / this->config_.capacity_ah;
+  this->soc_ = std::max(0.0f, std::min(this->soc_, 1.0f));
+
+  if (this->load_connected_ && this->voltage_v_ < this->config_.cutoff_v) {
+    this->load_connected_ = false;
+  } else if (!this->load_connected_ && this->mains_) {
+    this->load_connected_ = true;
+  }
+}
+
+}  // namespace host_sim
+}  // namespace esphome
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+namespace host_sim {
+
+struct BatteryConfig {
+  float capacity_ah;
+  uint8_t cells;
+  // open circuit voltage per cell at 0 % and 100 % state of charge, linear in between
+  float empty_cell_v;
+  float full_cell_v;
+  // last part of the charge where the voltage rises steeply, the absorption tail
+  float tail_soc;
+  float tail_cell_v;
+  float internal_resistance_ohm;
+  // loads are disconnected below this terminal voltage, like a low voltage disconnect
+  float cutoff_v;
+};
+
+// Lead acid bank charged by a CV/CC source. The charger holds its target voltage
+// at the terminals until the current limit, loads draw a constant current.
+class BatteryModel {
+ public:
+  explicit BatteryModel(const BatteryConfig &config) : config_(config) {}
+
+  void set_soc(float soc) { this->soc_ = soc; }
+  // target 0 or NAN switches the charger off
+  void set_charger(float target_v, float current_limit_a) {
+    this->target_v_ = target_v;
+    this->current_limit_a_ = current_limit_a;
+  }
+  void set_mains(bool mains) { this->mains_ = mains; }
+  void set_load(float load_a) { this->load_a_ = load_a; }
+
+  void step(float dt_s);
+
+  float get_soc() const { return this->soc_; }
+  float get_ocv() const;
+  float get_voltage() const { return this->voltage_v_; }
+  // positive while charging
+  float get_current() const { return this->current_a_; }
+  bool is_load_connected() const { return this->load_connected_; }
+  float get_capacity_ah() const { return this->config_.capacity_ah; }
+
+ protected:
+  BatteryConfig config_;
+  float soc_{1.0f};
+  float target_v_{0};
+  float current_limit_a_{0};
+  bool mains_{true};
+  float load_a_{0};
+  bool load_connected_{true};
+  float voltage_v_{0};
+  float current_a_{0};
+};
+
+}  // namespace host_sim
+}  // namespace esphome
@@ -0,0 +1,345 @@
+// Integration accuracy and cost of the INA219/INA226 calc_charge() hot path.
+// Every run replays a waveform through the simulated INA register model, calls
+// calc_charge() at a given period and jitter on the virtual clock, and compares
+// the integrated charge and energy with the exact integral of the waveform.
+#include "esphome/core/application.h"
+#include "esphome/core/log.h"
+#include "i2c_sim/i2c_sim.h"
+#include "ina219_coulomb/ina219_coulomb.h"
+#include "ina226_coulomb/ina226_coulomb.h"
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <sstream>
+
+namespace esphome {
+namespace host_sim {
+
+using i2c_sim::Trace;
+
+static const float SHUNT_OHM = 0.001f;
+static const float MAX_CURRENT_A = 80.0f;
+// synthetic waveforms are steps on this grid, the reference integral is exact on it
+static const int64_t GRID_US = 10;
+static const uint8_t ADDRESS = 0x40;
+
+// Exposes the integrator state of a driver, both keep the same members.
+template<typename T> class BenchIna : public T {
+ public:
+  double get_charge_mc() const { return this->latest_charge_mc_ + this->partial_charge_mc_; }
+  double get_energy_mj() const { return this->latest_energy_mj_ + this->partial_energy_mj_; }
+  uint32_t get_previous_time() const { return this->previous_time_; }
+  uint32_t get_reads() const { return this->charge_reads_count_; }
+  uint32_t get_gaps() const { return this->gap_detector_.get_gaps(); }
+};
+
+// Keeps the time spent in the register model out of the driver's cost.
+class BenchBus : public i2c_sim::I2CSimBus {
+ public:
+  i2c::ErrorCode readv(uint8_t address, i2c::ReadBuffer *buffers, size_t cnt) override {
+    const auto begin = std::chrono::steady_clock::now();
+    const auto err = this->I2CSimBus::readv(address, buffers, cnt);
+    this->busy_ += std::chrono::steady_clock::now() - begin;
+    return err;
+  }
+  i2c::ErrorCode writev(uint8_t address, i2c::WriteBuffer *buffers, size_t cnt, bool stop) override {
+    const auto begin = std::chrono::steady_clock::now();
+    const auto err = this->I2CSimBus::writev(address, buffers, cnt, stop);
+    this->busy_ += std::chrono::steady_clock::now() - begin;
+    return err;
+  }
+  std::chrono::steady_clock::duration get_busy() const { return this->busy_; }
+
+ protected:
+  std::chrono::steady_clock::duration busy_{};
+};
+
+struct Waveform {
+  const char *name;
+  const char *description;
+  Trace trace;
+};
+
+// bus voltage sags with the load, so the energy integral differs from charge × voltage
+static float bus_voltage(float current_a) { return 12.8f - 0.02f * current_a; }
+
+template<typename F> static Trace periodic_trace(int64_t period_us, F current) {
+  Trace trace;
+  for (int64_t t = 0; t < period_us; t += GRID_US) {
+    const float i = current(t);
+    trace.add(t, i, bus_voltage(i));
+  }
+  trace.set_loop(true);
+  return trace;
+}
+
+static std::vector<Waveform> synthetic_waveforms() {
+  std::vector<Waveform> waveforms;
+  waveforms.push_back({"dc", "5 A constant", periodic_trace(1000, [](int64_t t) { return 5.0f; })});
+  waveforms.push_back({"pwm_1k", "10 A PWM, 1 kHz, 30 % duty",
+                       periodic_trace(1000, [](int64_t t) { return t < 300 ? 10.0f : 0.0f; })});
+  waveforms.push_back({"pwm_10", "10 A PWM, 10 Hz, 50 % duty",
+                       periodic_trace(100000, [](int64_t t) { return t < 50000 ? 10.0f : 0.0f; })});
+  // single phase inverter: DC side current pulses at twice the line frequency
+  waveforms.push_back({"ripple", "inverter, 8 A mean, 100 Hz ripple", periodic_trace(10000, [](int64_t t) {
+                         return 8.0f * (1.0f - cosf(2 * M_PI * t / 10000.0f));
+                       })});
+  // motor start every 2 s: 60 A inrush decaying to 6 A running current, off after 1 s
+  waveforms.push_back({"inrush", "motor, 60 A inrush, 1 s on / 1 s off", periodic_trace(2000000, [](int64_t t) {
+                         return t < 1000000 ? 6.0f + 54.0f * expf(-t / 50000.0f) : 0.0f;
+                       })});
+  return waveforms;
+}
+
+struct Chip {
+  const char *name;
+  i2c_sim::InaVariant variant;
+  // INA226 ADC settings, the INA219 driver has fixed ones (12 bit, 128 samples)
+  ina226_coulomb::AdcTime adc_time;
+  ina226_coulomb::AdcAvgSamples avg_samples;
+};
+
+static const Chip CHIPS[] = {
+    {"ina219", i2c_sim::INA_VARIANT_219, ina226_coulomb::ADC_TIME_1100US, ina226_coulomb::ADC_AVG_SAMPLES_4},
+    {"ina226", i2c_sim::INA_VARIANT_226, ina226_coulomb::ADC_TIME_1100US, ina226_coulomb::ADC_AVG_SAMPLES_4},
+    {"ina226_fast", i2c_sim::INA_VARIANT_226, ina226_coulomb::ADC_TIME_140US, ina226_coulomb::ADC_AVG_SAMPLES_1},
+};
+
+struct Options {
+  float seconds{20};
+  std::vector<uint32_t> periods_ms{1, 2, 5, 10};
+  std::vector<uint32_t> jitters_us{0, 2000};
+  // about once a second, at a random phase, a call is late by this much, like an OTA or WiFi stall
+  uint32_t stall_ms{0};
+  std::vector<std::string> waveforms;
+  std::string trace_file;
+  bool csv{false};
+};
+
+struct Result {
+  double charge_error;
+  double energy_error;
+  double rate_hz;
+  // host CPU time of calc_charge() without the simulated transfers
+  double ns_per_call;
+  uint32_t calls;
+  uint32_t gaps;
+};
+
+// the driver after setup(), calc_charge() is driven by the benchmark instead of its interval
+template<typename T> static void setup_driver(T &ina, const Chip &chip, BenchBus &bus);
+
+template<> void setup_driver(BenchIna<ina219_coulomb::INA219Component> &ina, const Chip &chip, BenchBus &bus) {
+  ina.set_max_voltage_v(16.0f);
+}
+
+template<> void setup_driver(BenchIna<ina226_coulomb::INA226Component> &ina, const Chip &chip, BenchBus &bus) {
+  ina.set_adc_time_current(chip.adc_time);
+  ina.set_adc_time_voltage(chip.adc_time);
+  ina.set_adc_avg_samples(chip.avg_samples);
+}
+
+template<typename T>
+static Result run_one(const Chip &chip, const Trace &waveform, const Options &options, uint32_t period_ms,
+                      uint32_t jitter_us) {
+  // start on a whole millisecond, the driver's time base
+  host_sim::set_now_us((host_sim::now_us() / 1000 + 1) * 1000);
+  const uint64_t epoch_us = host_sim::now_us();
+
+  BenchBus bus;
+  i2c_sim::InaSimDevice device(ADDRESS, chip.variant, SHUNT_OHM);
+  device.get_trace() = waveform;
+  bus.add_device(&device);
+  bus.setup();
+
+  BenchIna<T> ina;
+  ina.set_i2c_bus(&bus);
+  ina.set_i2c_address(ADDRESS);
+  ina.set_shunt_resistance_ohm(SHUNT_OHM);
+  ina.set_max_current_a(MAX_CURRENT_A);
+  ina.set_update_interval(60000);
+  setup_driver(ina, chip, bus);
+  App.set_loop_component_start_time(millis());
+  ina.setup();
+  App.scheduler.cancel_interval(&ina, "calcCharge");
+  const uint32_t start_ms = ina.get_previous_time();
+
+  std::mt19937 random(period_ms * 7919 + jitter_us);
+  std::uniform_int_distribution<uint32_t> jitter(0, jitter_us);
+  const uint64_t end_us = epoch_us + uint64_t(options.seconds * 1e6);
+  uint64_t next_us = host_sim::now_us();
+  // stalls off the waveforms' periods, which are divisors of a second
+  std::mt19937 stall_random(period_ms * 104729 + jitter_us);
+  std::uniform_int_distribution<uint32_t> stall_spacing(500000, 1500000);
+  uint64_t next_stall_us = next_us + stall_spacing(stall_random);
+  uint32_t calls = 0;
+  std::chrono::steady_clock::duration busy{};
+  const auto bus_before = bus.get_busy();
+  while (true) {
+    next_us += uint64_t(period_ms) * 1000 + jitter(random);
+    if (options.stall_ms != 0 && next_us >= next_stall_us) {
+      next_us += uint64_t(options.stall_ms) * 1000;
+      next_stall_us += stall_spacing(stall_random);
+    }
+    if (next_us > end_us) {
+      break;
+    }
+    // the meter's own intervals keep running in between
+    App.run_until_us(next_us);
+    App.set_loop_component_start_time(millis());
+    const auto begin = std::chrono::steady_clock::now();
+    ina.calc_charge();
+    busy += std::chrono::steady_clock::now() - begin;
+    calls++;
+  }
+  // on the chip the transfers are I2C time, not CPU time of the integrator
+  busy -= bus.get_busy() - bus_before;
+  App.scheduler.cancel_all(&ina);
+  App.scheduler.cancel_all(&bus);
+
+  // reference over the window the driver integrated, in trace time
+  const uint32_t end_ms = ina.get_previous_time();
+  Trace reference = waveform;
+  double charge_mc = 0;
+  double energy_mj = 0;
+  for (int64_t t = int64_t(start_ms) * 1000 - int64_t(epoch_us); t < int64_t(end_ms) * 1000 - int64_t(epoch_us);
+       t += GRID_US) {
+    const auto point = reference.sample(t);
+    charge_mc += point.current_a * GRID_US / 1000.0;
+    energy_mj += point.current_a * point.voltage_v * GRID_US / 1000.0;
+  }
+
+  Result result;
+  result.charge_error = (ina.get_charge_mc() - charge_mc) / charge_mc * 100;
+  result.energy_error = (ina.get_energy_mj() - energy_mj) / energy_mj * 100;
+  result.rate_hz = ina.get_reads() / options.seconds;
+  result.ns_per_call = calls == 0 ? 0 : std::chrono::duration<double, std::nano>(busy).count() / calls;
+  result.calls = calls;
+  result.gaps = ina.get_gaps();
+  return result;
+}
+
+static std::vector<uint32_t> parse_list(const char *value) {
+  std::vector<uint32_t> list;
+  std::stringstream stream(value);
+  std::string item;
+  while (std::getline(stream, item, ',')) {
+    list.push_back(strtoul(item.c_str(), nullptr, 10));
+  }
+  return list;
+}
+
+static int run(const Options &options) {
+  std::vector<Waveform> waveforms;
+  for (auto &waveform : synthetic_waveforms()) {
+    if (options.waveforms.empty() ||
+        std::find(options.waveforms.begin(), options.waveforms.end(), waveform.name) != options.waveforms.end()) {
+      waveforms.push_back(std::move(waveform));
+    }
+  }
+  if (!options.trace_file.empty()) {
+    Waveform recorded{"recorded", "", {}};
+    if (!recorded.trace.load(options.trace_file)) {
+      fprintf(stderr, "%s\n", recorded.trace.get_error().c_str());
+      return 1;
+    }
+    recorded.trace.set_loop(true);
+    recorded.description = options.trace_file.c_str();
+    waveforms.push_back(std::move(recorded));
+  }
+  if (waveforms.empty()) {
+    fprintf(stderr, "No waveform selected\n");
+    return 2;
+  }
+
+  if (options.csv) {
+    printf("waveform,chip,period_ms,jitter_us,rate_hz,charge_error_pct,energy_error_pct,ns_per_call,gaps\n");
+  } else {
+    printf("%.0f s per run, shunt %.1f mOhm, reference integral on a %u us grid\n", options.seconds, SHUNT_OHM * 1000,
+           (unsigned) GRID_US);
+    if (options.stall_ms != 0) {
+      printf("%u ms stall about every second\n", options.stall_ms);
+    }
+    for (auto &waveform : waveforms) {
+      printf("  %-8s %s\n", waveform.name, waveform.description);
+    }
+    printf("\n%-8s %-12s %6s %7s %9s %10s %10s %8s %6s\n", "waveform", "chip", "period", "jitter", "rate", "charge",
+           "energy", "cpu", "gaps");
+    printf("%-8s %-12s %6s %7s %9s %10s %10s %8s\n", "", "", "ms", "us", "Hz", "error %", "error %", "ns/call");
+  }
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  for (auto &waveform : waveforms) {
+    for (const auto &chip : CHIPS) {
+      for (uint32_t period : options.periods_ms) {
+        for (uint32_t jitter : options.jitters_us) {
+          const Result result =
+              chip.variant == i2c_sim::INA_VARIANT_219
+                  ? run_one<ina219_coulomb::INA219Component>(chip, waveform.trace, options, period, jitter)
+                  : run_one<ina226_coulomb::INA226Component>(chip, waveform.trace, options, period, jitter);
+          if (options.csv) {
+            printf("%s,%s,%u,%u,%.1f,%.4f,%.4f,%.1f,%u\n", waveform.name, chip.name, period, jitter, result.rate_hz,
+                   result.charge_error, result.energy_error, result.ns_per_call, result.gaps);
+          } else {
+            printf("%-8s %-12s %6u %7u %9.1f %+10.3f %+10.3f %8.1f %6u\n", waveform.name, chip.name, period, jitter,
+                   result.rate_hz, result.charge_error, result.energy_error, result.ns_per_call, result.gaps);
+          }
+        }
+      }
+    }
+  }
+  if (!options.csv) {
+    printf("\nDone in %.1f s\n",
+           std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count());
+  }
+  return 0;
+}
+
+static void usage(const char *name) {
+  printf("Usage: %s [--seconds S] [--periods MS,..] [--jitters US,..] [--stall MS] [--waveform NAME]... [--trace FILE] "
+         "[--csv]\n",
+         name);
+}
+
+}  // namespace host_sim
+}  // namespace esphome
+
+int main(int argc, char **argv) {
+  using namespace esphome;
+  host_sim::Options options;
+  log_level = LOG_LEVEL_ERROR;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--seconds") == 0 && has_value) {
+      options.seconds = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--periods") == 0 && has_value) {
+      options.periods_ms = host_sim::parse_list(argv[++i]);
+    } else if (strcmp(argv[i], "--jitters") == 0 && has_value) {
+      options.jitters_us = host_sim::parse_list(argv[++i]);
+    } else if (strcmp(argv[i], "--stall") == 0 && has_value) {
+      options.stall_ms = strtoul(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--waveform") == 0 && has_value) {
+      options.waveforms.push_back(argv[++i]);
+    } else if (strcmp(argv[i], "--trace") == 0 && has_value) {
+      options.trace_file = argv[++i];
+    } else if (strcmp(argv[i], "--csv") == 0) {
+      options.csv = true;
+    } else {
+      host_sim::usage(argv[0]);
+      return 2;
+    }
+  }
+  if (options.seconds <= 0 || options.periods_ms.empty() || options.jitters_us.empty()) {
+    host_sim::usage(argv[0]);
+    return 2;
+  }
+  for (uint32_t period : options.periods_ms) {
+    if (period == 0) {
+      host_sim::usage(argv[0]);
+      return 2;
+    }
+  }
+  return host_sim::run(options);
+}
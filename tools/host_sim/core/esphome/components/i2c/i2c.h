@@ -0,0 +1,33 @@
+#pragma once
+
+#include "esphome/components/i2c/i2c_bus.h"
+#include "esphome/core/optional.h"
+
+namespace esphome {
+namespace i2c {
+
+class I2CDevice {
+ public:
+  I2CDevice() = default;
+  void set_i2c_address(uint8_t address) { this->address_ = address; }
+  uint8_t get_i2c_address() const { return this->address_; }
+  void set_i2c_bus(I2CBus *bus) { this->bus_ = bus; }
+
+  ErrorCode read(uint8_t *data, size_t len) { return this->bus_->read(this->address_, data, len); }
+  ErrorCode write(const uint8_t *data, size_t len, bool stop = true) { return this->bus_->write(this->address_, data, len, stop); }
+  ErrorCode read_register(uint8_t a_register, uint8_t *data, size_t len, bool stop = true);
+  ErrorCode write_register(uint8_t a_register, const uint8_t *data, size_t len, bool stop = true);
+  bool read_bytes(uint8_t a_register, uint8_t *data, uint8_t len) {
+    return this->read_register(a_register, data, len) == ERROR_OK;
+  }
+  // big endian, like the INA registers
+  bool read_byte_16(uint8_t a_register, uint16_t *data);
+  bool write_byte_16(uint8_t a_register, uint16_t data);
+
+ protected:
+  uint8_t address_{0x00};
+  I2CBus *bus_{nullptr};
+};
+
+}  // namespace i2c
+}  // namespace esphome
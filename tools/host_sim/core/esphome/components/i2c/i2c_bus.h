@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace esphome {
+namespace i2c {
+
+enum ErrorCode {
+  NO_ERROR = 0,
+  ERROR_OK = 0,
+  ERROR_INVALID_ARGUMENT = 1,
+  ERROR_NOT_ACKNOWLEDGED = 2,
+  ERROR_TIMEOUT = 3,
+  ERROR_NOT_INITIALIZED = 4,
+  ERROR_TOO_LARGE = 5,
+  ERROR_UNKNOWN = 6,
+  ERROR_CRC = 7,
+};
+
+struct ReadBuffer {
+  uint8_t *data;
+  size_t len;
+};
+
+struct WriteBuffer {
+  const uint8_t *data;
+  size_t len;
+};
+
+class I2CBus {
+ public:
+  virtual ~I2CBus() = default;
+  virtual ErrorCode read(uint8_t address, uint8_t *buffer, size_t len) {
+    ReadBuffer buf{buffer, len};
+    return this->readv(address, &buf, 1);
+  }
+  virtual ErrorCode readv(uint8_t address, ReadBuffer *buffers, size_t cnt) = 0;
+  virtual ErrorCode write(uint8_t address, const uint8_t *buffer, size_t len) { return this->write(address, buffer, len, true); }
+  virtual ErrorCode write(uint8_t address, const uint8_t *buffer, size_t len, bool stop) {
+    WriteBuffer buf{buffer, len};
+    return this->writev(address, &buf, 1, stop);
+  }
+  virtual ErrorCode writev(uint8_t address, WriteBuffer *buffers, size_t cnt) { return this->writev(address, buffers, cnt, true); }
+  virtual ErrorCode writev(uint8_t address, WriteBuffer *buffers, size_t cnt, bool stop) = 0;
+
+ protected:
+  std::vector<std::pair<uint8_t, bool>> scan_results_;
+  bool scan_{false};
+};
+
+}  // namespace i2c
+}  // namespace esphome
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace output {
+
+class BinaryOutput {
+ public:
+  virtual ~BinaryOutput() = default;
+  virtual void turn_on() { this->write_state(1.0f); }
+  virtual void turn_off() { this->write_state(0.0f); }
+
+ protected:
+  virtual void write_state(float state) = 0;
+};
+
+// Scales like the firmware output: 0 stays off, everything else maps into [min_power, max_power].
+class FloatOutput : public BinaryOutput {
+ public:
+  void set_level(float state) {
+    state = clamp(state, 0.0f, 1.0f);
+    this->level_ = state;
+    if (state != 0.0f) {
+      state = this->min_power_ + state * (this->max_power_ - this->min_power_);
+    }
+    this->write_state(state);
+  }
+  void set_max_power(float max_power) { this->max_power_ = max_power; }
+  void set_min_power(float min_power) { this->min_power_ = min_power; }
+  float get_level() const { return this->level_; }
+
+ protected:
+  float level_{0.0f};
+  float min_power_{0.0f};
+  float max_power_{1.0f};
+};
+
+}  // namespace output
+}  // namespace esphome
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cmath>
+#include <functional>
+#include "esphome/core/component.h"
+#include "esphome/core/entity_base.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace sensor {
+
+// No filters on the host, raw and filtered state are the same.
+class Sensor : public EntityBase {
+ public:
+  explicit Sensor(const std::string &name = "") { this->set_name(name); }
+
+  void publish_state(float state) {
+    this->raw_state = state;
+    this->state = state;
+    this->has_state_ = true;
+    this->publishes_++;
+    this->raw_callback_.call(state);
+    this->callback_.call(state);
+  }
+  void add_on_state_callback(std::function<void(float)> &&callback) { this->callback_.add(std::move(callback)); }
+  void add_on_raw_state_callback(std::function<void(float)> &&callback) { this->raw_callback_.add(std::move(callback)); }
+
+  float get_state() const { return this->state; }
+  float get_raw_state() const { return this->raw_state; }
+  bool get_force_update() const { return false; }
+  int8_t get_accuracy_decimals() const { return 2; }
+  // publish_state() calls so far, for the harness reports
+  uint32_t get_publishes() const { return this->publishes_; }
+
+  float state{NAN};
+  float raw_state{NAN};
+
+ protected:
+  CallbackManager<void(float)> callback_;
+  CallbackManager<void(float)> raw_callback_;
+  uint32_t publishes_{0};
+};
+
+}  // namespace sensor
+}  // namespace esphome
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include "esphome/core/component.h"
+#include "esphome/core/entity_base.h"
+#include "esphome/core/helpers.h"
+
+namespace esphome {
+namespace text_sensor {
+
+class TextSensor : public EntityBase {
+ public:
+  explicit TextSensor(const std::string &name = "") { this->set_name(name); }
+
+  void publish_state(const std::string &state) {
+    this->state = state;
+    this->has_state_ = true;
+    this->callback_.call(state);
+  }
+  void add_on_state_callback(std::function<void(std::string)> callback) { this->callback_.add(std::move(callback)); }
+
+  std::string state;
+
+ protected:
+  CallbackManager<void(std::string)> callback_;
+};
+
+}  // namespace text_sensor
+}  // namespace esphome
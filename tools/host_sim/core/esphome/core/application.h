@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "esphome/core/component.h"
+#include "esphome/core/defines.h"
+#include "esphome/core/scheduler.h"
+#ifdef USE_SENSOR
+#include "esphome/components/sensor/sensor.h"
+#endif
+#ifdef USE_TEXT_SENSOR
+#include "esphome/components/text_sensor/text_sensor.h"
+#endif
+
+namespace esphome {
+
+class Application {
+ public:
+  void register_component(Component *component) { this->components_.push_back(component); }
+  // setup() by descending priority, like the firmware
+  void setup();
+  void dump_config();
+  void shutdown();
+
+  // moves the virtual clock to time_us, running every scheduler item and
+  // enabled loop() on the way; time jumps straight from one item to the next
+  void run_until_us(uint64_t time_us);
+  // loop() of components that keep it enabled runs every loop_interval_ms; 0 (the
+  // default) only wakes for scheduler items, which is all the linked components need
+  void set_loop_interval(uint32_t loop_interval_ms) { this->loop_interval_ms_ = loop_interval_ms; }
+
+  uint32_t get_loop_component_start_time() const { return this->loop_component_start_time_; }
+  void set_loop_component_start_time(uint32_t time) { this->loop_component_start_time_ = time; }
+  uint64_t get_loops() const { return this->loops_; }
+
+  Scheduler scheduler;
+
+ protected:
+  void loop_();
+
+  std::vector<Component *> components_;
+  uint32_t loop_component_start_time_{0};
+  uint32_t loop_interval_ms_{0};
+  uint64_t last_loop_us_{0};
+  uint64_t loops_{0};
+};
+
+extern Application App;
+
+}  // namespace esphome
@@ -0,0 +1,29 @@
+#pragma once
+
+#include "esphome/core/component.h"
+
+namespace esphome {
+
+template<typename... Ts> class Trigger {
+ public:
+  void trigger(Ts... x) {}
+};
+
+template<typename... Ts> class Action {
+ public:
+  virtual ~Action() = default;
+  virtual void play(Ts... x) = 0;
+};
+
+template<typename T> class Parented {
+ public:
+  Parented() {}
+  Parented(T *parent) : parent_(parent) {}
+  T *get_parent() const { return this->parent_; }
+  void set_parent(T *parent) { this->parent_ = parent; }
+
+ protected:
+  T *parent_{nullptr};
+};
+
+}  // namespace esphome
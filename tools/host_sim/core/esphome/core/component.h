@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/optional.h"
+#include "esphome/core/preferences.h"
+
+namespace esphome {
+
+namespace setup_priority {
+extern const float BUS;
+extern const float IO;
+extern const float HARDWARE;
+extern const float DATA;
+extern const float PROCESSOR;
+extern const float LATE;
+}  // namespace setup_priority
+
+class Component {
+ public:
+  virtual ~Component() = default;
+  virtual void setup() {}
+  virtual void loop() {}
+  virtual void dump_config() {}
+  virtual float get_setup_priority() const { return setup_priority::DATA; }
+  virtual void on_shutdown() {}
+  virtual void on_powerdown() {}
+
+  // setup(), then whatever the component type adds (polling)
+  virtual void call_setup() { this->setup(); }
+
+  void mark_failed();
+  void mark_failed(const char *message);
+  bool is_failed() const { return this->failed_; }
+  bool is_ready() const { return !this->failed_; }
+
+  void status_set_warning(const char *message = "unspecified") { this->warning_ = true; }
+  void status_set_error(const char *message = "unspecified") { this->error_ = true; }
+  void status_clear_warning() { this->warning_ = false; }
+  void status_clear_error() { this->error_ = false; }
+  bool status_has_warning() const { return this->warning_; }
+  bool status_has_error() const { return this->error_; }
+
+  void enable_loop() { this->loop_enabled_ = true; }
+  void disable_loop() { this->loop_enabled_ = false; }
+  bool is_loop_enabled() const { return this->loop_enabled_; }
+
+ protected:
+  void set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f);
+  void set_interval(uint32_t interval, std::function<void()> &&f);
+  bool cancel_interval(const std::string &name);
+  void set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f);
+  void set_timeout(uint32_t timeout, std::function<void()> &&f);
+  bool cancel_timeout(const std::string &name);
+  void defer(std::function<void()> &&f) { this->set_timeout(0, std::move(f)); }
+
+  bool failed_{false};
+  bool warning_{false};
+  bool error_{false};
+  // the harness only runs loop() of components that keep it enabled
+  bool loop_enabled_{true};
+};
+
+class PollingComponent : public Component {
+ public:
+  PollingComponent() : PollingComponent(0) {}
+  explicit PollingComponent(uint32_t update_interval) : update_interval_(update_interval) {}
+
+  virtual void set_update_interval(uint32_t update_interval) { this->update_interval_ = update_interval; }
+  virtual uint32_t get_update_interval() const { return this->update_interval_; }
+  virtual void update() = 0;
+
+  void call_setup() override;
+
+ protected:
+  uint32_t update_interval_;
+};
+
+}  // namespace esphome
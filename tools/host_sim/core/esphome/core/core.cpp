@@ -0,0 +1,342 @@
+#include "esphome/core/application.h"
+#include "esphome/core/component.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/helpers.h"
+#include "esphome/core/log.h"
+#include "esphome/core/preferences.h"
+#include "esphome/core/scheduler.h"
+#include "esphome/components/i2c/i2c.h"
+#include <algorithm>
+#include <cstdarg>
+#include <map>
+
+namespace esphome {
+
+static const char *const TAG = "host_sim";
+
+// --- virtual clock ---
+
+static uint64_t now_us_ = 0;
+
+namespace host_sim {
+
+uint64_t now_us() { return now_us_; }
+void set_now_us(uint64_t now_us) {
+  if (now_us > now_us_) {
+    now_us_ = now_us;
+  }
+}
+
+}  // namespace host_sim
+
+// both wrap like on the chips, millis() after 49.7 days
+uint32_t millis() { return (uint32_t) (now_us_ / 1000); }
+uint32_t micros() { return (uint32_t) now_us_; }
+void delay(uint32_t ms) { now_us_ += uint64_t(ms) * 1000; }
+void delayMicroseconds(uint32_t us) { now_us_ += us; }
+
+// --- logging ---
+
+LogLevel log_level = LOG_LEVEL_INFO;
+
+void log_printf(LogLevel level, const char *tag, const char *format, ...) {
+  static const char LETTERS[] = "-EWICDVV";
+  const uint64_t ms = now_us_ / 1000;
+  const uint64_t s = ms / 1000;
+  printf("[%3" PRIu64 "d %02u:%02u:%02u.%03u][%c][%s]: ", s / 86400, unsigned(s / 3600 % 24), unsigned(s / 60 % 60),
+         unsigned(s % 60), unsigned(ms % 1000), LETTERS[level], tag);
+  va_list args;
+  va_start(args, format);
+  vprintf(format, args);
+  va_end(args);
+  putchar('\n');
+}
+
+// --- helpers ---
+
+uint32_t fnv1_hash(const std::string &str) {
+  uint32_t hash = 2166136261UL;
+  for (char c : str) {
+    hash *= 16777619UL;
+    hash ^= c;
+  }
+  return hash;
+}
+
+// --- preferences ---
+
+class HostPreferences : public ESPPreferences {
+ public:
+  ESPPreferenceObject make_preference(size_t length, uint32_t type, bool in_flash) override {
+    Slot &slot = this->slots_[type];
+    slot.in_flash = in_flash;
+    return ESPPreferenceObject(&slot.data);
+  }
+
+  void clear_rtc() {
+    for (auto &it : this->slots_) {
+      if (!it.second.in_flash) {
+        it.second.data.clear();
+      }
+    }
+  }
+
+ protected:
+  struct Slot {
+    std::vector<uint8_t> data;
+    bool in_flash;
+  };
+  // map nodes stay in place, preference objects keep pointing at their slot
+  std::map<uint32_t, Slot> slots_;
+};
+
+static HostPreferences host_preferences;
+ESPPreferences *global_preferences = &host_preferences;
+
+namespace host_sim {
+
+void clear_rtc_preferences() { host_preferences.clear_rtc(); }
+
+}  // namespace host_sim
+
+// --- component ---
+
+namespace setup_priority {
+const float BUS = 1000.0f;
+const float IO = 900.0f;
+const float HARDWARE = 800.0f;
+const float DATA = 600.0f;
+const float PROCESSOR = 400.0f;
+const float LATE = -100.0f;
+}  // namespace setup_priority
+
+void Component::mark_failed() {
+  ESP_LOGE(TAG, "Component was marked as failed");
+  this->failed_ = true;
+  this->loop_enabled_ = false;
+  App.scheduler.cancel_all(this);
+}
+void Component::mark_failed(const char *message) {
+  ESP_LOGE(TAG, "Component was marked as failed: %s", message);
+  this->mark_failed();
+}
+
+void Component::set_interval(const std::string &name, uint32_t interval, std::function<void()> &&f) {
+  App.scheduler.set_interval(this, name, interval, std::move(f));
+}
+void Component::set_interval(uint32_t interval, std::function<void()> &&f) {
+  App.scheduler.set_interval(this, "", interval, std::move(f));
+}
+bool Component::cancel_interval(const std::string &name) { return App.scheduler.cancel_interval(this, name); }
+void Component::set_timeout(const std::string &name, uint32_t timeout, std::function<void()> &&f) {
+  App.scheduler.set_timeout(this, name, timeout, std::move(f));
+}
+void Component::set_timeout(uint32_t timeout, std::function<void()> &&f) {
+  App.scheduler.set_timeout(this, "", timeout, std::move(f));
+}
+bool Component::cancel_timeout(const std::string &name) { return App.scheduler.cancel_timeout(this, name); }
+
+void PollingComponent::call_setup() {
+  this->setup();
+  if (!this->is_failed() && this->update_interval_ != 0) {
+    this->set_interval("update", this->update_interval_, [this]() { this->update(); });
+  }
+}
+
+// --- scheduler ---
+
+void Scheduler::set_timeout(Component *component, const std::string &name, uint32_t timeout,
+                            std::function<void()> func) {
+  this->add_(component, name, false, timeout, std::move(func));
+}
+bool Scheduler::cancel_timeout(Component *component, const std::string &name) {
+  return this->cancel_(component, name, false);
+}
+void Scheduler::set_interval(Component *component, const std::string &name, uint32_t interval,
+                             std::function<void()> func) {
+  this->add_(component, name, true, interval, std::move(func));
+}
+bool Scheduler::cancel_interval(Component *component, const std::string &name) {
+  return this->cancel_(component, name, true);
+}
+
+void Scheduler::cancel_all(Component *component) {
+  for (auto &item : this->items_) {
+    if (item->component == component && !item->removed) {
+      item->removed = true;
+      this->removed_count_++;
+    }
+  }
+}
+
+void Scheduler::add_(Component *component, const std::string &name, bool interval, uint32_t period_ms,
+                     std::function<void()> func) {
+  // a name is unique per component and type, setting it again replaces the item
+  if (!name.empty()) {
+    this->cancel_(component, name, interval);
+  }
+  // the firmware runs 0 ms intervals every loop, here they would never let time move
+  if (interval && period_ms == 0) {
+    period_ms = 1;
+  }
+  auto item = std::unique_ptr<Item>(new Item{component, name, interval, period_ms,
+                                             now_us_ + uint64_t(period_ms) * 1000, this->seq_++, std::move(func), false});
+  this->items_.push_back(std::move(item));
+}
+
+bool Scheduler::cancel_(Component *component, const std::string &name, bool interval) {
+  bool found = false;
+  for (auto &item : this->items_) {
+    if (item->component == component && item->interval == interval && !item->removed && item->name == name) {
+      item->removed = true;
+      this->removed_count_++;
+      found = true;
+    }
+  }
+  return found;
+}
+
+Scheduler::Item *Scheduler::next_() const {
+  Item *next = nullptr;
+  for (auto &item : this->items_) {
+    if (item->removed) {
+      continue;
+    }
+    if (next == nullptr || item->due_us < next->due_us || (item->due_us == next->due_us && item->seq < next->seq)) {
+      next = item.get();
+    }
+  }
+  return next;
+}
+
+uint64_t Scheduler::next_due_us() const {
+  const Item *next = this->next_();
+  return next == nullptr ? UINT64_MAX : next->due_us;
+}
+
+void Scheduler::call() {
+  // items added by a callback run in a later call, even when already due
+  const uint64_t last_seq = this->seq_;
+  const uint64_t now = now_us_;
+  while (true) {
+    Item *item = this->next_();
+    if (item == nullptr || item->due_us > now || item->seq >= last_seq) {
+      break;
+    }
+    if (item->interval) {
+      item->due_us += uint64_t(item->period_ms) * 1000;
+      // a callback that delayed past several periods does not get a burst of catch-up calls
+      if (item->due_us <= now_us_) {
+        item->due_us = now_us_ + uint64_t(item->period_ms) * 1000;
+      }
+      item->seq = this->seq_++;
+    } else {
+      item->removed = true;
+      this->removed_count_++;
+    }
+    App.set_loop_component_start_time(millis());
+    this->executed_++;
+    // the item stays alive until cleanup, even if the callback cancels it
+    item->func();
+  }
+  this->cleanup_();
+}
+
+void Scheduler::cleanup_() {
+  if (this->removed_count_ < 16) {
+    return;
+  }
+  this->items_.erase(std::remove_if(this->items_.begin(), this->items_.end(),
+                                    [](const std::unique_ptr<Item> &item) { return item->removed; }),
+                     this->items_.end());
+  this->removed_count_ = 0;
+}
+
+// --- application ---
+
+Application App;
+
+void Application::setup() {
+  std::stable_sort(this->components_.begin(), this->components_.end(), [](Component *a, Component *b) {
+    return a->get_setup_priority() > b->get_setup_priority();
+  });
+  for (auto *component : this->components_) {
+    this->loop_component_start_time_ = millis();
+    component->call_setup();
+  }
+}
+
+void Application::dump_config() {
+  for (auto *component : this->components_) {
+    component->dump_config();
+  }
+}
+
+void Application::shutdown() {
+  for (auto *component : this->components_) {
+    component->on_shutdown();
+  }
+}
+
+void Application::loop_() {
+  this->loops_++;
+  for (auto *component : this->components_) {
+    if (component->is_loop_enabled() && !component->is_failed()) {
+      this->loop_component_start_time_ = millis();
+      component->loop();
+    }
+  }
+}
+
+void Application::run_until_us(uint64_t time_us) {
+  while (true) {
+    const uint64_t next_item = this->scheduler.next_due_us();
+    const uint64_t next_loop =
+        this->loop_interval_ms_ == 0 ? UINT64_MAX : this->last_loop_us_ + uint64_t(this->loop_interval_ms_) * 1000;
+    const uint64_t next = std::min(next_item, next_loop);
+    if (next > time_us) {
+      break;
+    }
+    host_sim::set_now_us(next);
+    this->scheduler.call();
+    if (this->loop_interval_ms_ != 0 && now_us_ >= next_loop) {
+      this->last_loop_us_ = now_us_;
+      this->loop_();
+    }
+  }
+  host_sim::set_now_us(time_us);
+}
+
+// --- i2c ---
+
+namespace i2c {
+
+ErrorCode I2CDevice::read_register(uint8_t a_register, uint8_t *data, size_t len, bool stop) {
+  ErrorCode err = this->write(&a_register, 1, stop);
+  if (err != ERROR_OK) {
+    return err;
+  }
+  return this->read(data, len);
+}
+
+ErrorCode I2CDevice::write_register(uint8_t a_register, const uint8_t *data, size_t len, bool stop) {
+  WriteBuffer buffers[2] = {{&a_register, 1}, {data, len}};
+  return this->bus_->writev(this->address_, buffers, 2, stop);
+}
+
+bool I2CDevice::read_byte_16(uint8_t a_register, uint16_t *data) {
+  uint8_t bytes[2];
+  if (this->read_register(a_register, bytes, 2) != ERROR_OK) {
+    return false;
+  }
+  *data = (uint16_t(bytes[0]) << 8) | bytes[1];
+  return true;
+}
+
+bool I2CDevice::write_byte_16(uint8_t a_register, uint16_t data) {
+  const uint8_t bytes[2] = {uint8_t(data >> 8), uint8_t(data & 0xFF)};
+  return this->write_register(a_register, bytes, 2) == ERROR_OK;
+}
+
+}  // namespace i2c
+}  // namespace esphome
@@ -0,0 +1,10 @@
+#pragma once
+
+// Features of the components linked into the host harness.
+#define USE_HOST
+#define USE_SENSOR
+#define USE_TEXT_SENSOR
+#define USE_OUTPUT
+#define USE_BATTERY_CHARGER_COULOMB_METER
+#define USE_BATTERY_CHARGER_EVENT_LOG
+#define BATTERY_CHARGER_EVENT_LOG_SIZE 64
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+namespace esphome {
+
+class EntityBase {
+ public:
+  const std::string &get_name() const { return this->name_; }
+  void set_name(const std::string &name) { this->name_ = name; }
+  bool has_state() const { return this->has_state_; }
+
+ protected:
+  std::string name_;
+  bool has_state_{false};
+};
+
+}  // namespace esphome
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+
+namespace esphome {
+
+// Virtual clock of the host harness, time only moves when the harness advances it.
+uint32_t millis();
+uint32_t micros();
+// blocking delays let the virtual time pass
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+
+namespace host_sim {
+
+uint64_t now_us();
+void set_now_us(uint64_t now_us);
+
+}  // namespace host_sim
+}  // namespace esphome
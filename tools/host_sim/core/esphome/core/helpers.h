@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+#include "esphome/core/optional.h"
+
+#define YESNO(b) ((b) ? "YES" : "NO")
+
+namespace esphome {
+
+uint32_t fnv1_hash(const std::string &str);
+
+template<typename T> T clamp(T value, T min, T max) { return value < min ? min : (value > max ? max : value); }
+
+template<typename... X> class CallbackManager;
+
+template<typename... Ts> class CallbackManager<void(Ts...)> {
+ public:
+  void add(std::function<void(Ts...)> &&callback) { this->callbacks_.push_back(std::move(callback)); }
+  void call(Ts... args) {
+    for (auto &callback : this->callbacks_) {
+      callback(args...);
+    }
+  }
+  size_t size() const { return this->callbacks_.size(); }
+
+ protected:
+  std::vector<std::function<void(Ts...)>> callbacks_;
+};
+
+// the virtual clock runs the loop on demand, there is nothing to speed up
+class HighFrequencyLoopRequester {
+ public:
+  void start() {}
+  void stop() {}
+};
+
+}  // namespace esphome
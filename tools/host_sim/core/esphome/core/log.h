@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cinttypes>
+#include <cstdio>
+
+namespace esphome {
+
+enum LogLevel : uint8_t {
+  LOG_LEVEL_NONE,
+  LOG_LEVEL_ERROR,
+  LOG_LEVEL_WARN,
+  LOG_LEVEL_INFO,
+  LOG_LEVEL_CONFIG,
+  LOG_LEVEL_DEBUG,
+  LOG_LEVEL_VERBOSE,
+  LOG_LEVEL_VERY_VERBOSE,
+};
+
+// runtime level, messages above it are dropped before formatting
+extern LogLevel log_level;
+void log_printf(LogLevel level, const char *tag, const char *format, ...) __attribute__((format(printf, 3, 4)));
+
+}  // namespace esphome
+
+#define ESPHOME_LOG_HAS_ERROR
+#define ESPHOME_LOG_HAS_WARN
+#define ESPHOME_LOG_HAS_INFO
+#define ESPHOME_LOG_HAS_CONFIG
+#define ESPHOME_LOG_HAS_DEBUG
+#define ESPHOME_LOG_HAS_VERBOSE
+
+#define ESPHOME_LOG_(level, tag, ...) \
+  do { \
+    if (::esphome::log_level >= (level)) { \
+      ::esphome::log_printf((level), (tag), __VA_ARGS__); \
+    } \
+  } while (0)
+
+#define ESP_LOGE(tag, ...) ESPHOME_LOG_(::esphome::LOG_LEVEL_ERROR, tag, __VA_ARGS__)
+#define ESP_LOGW(tag, ...) ESPHOME_LOG_(::esphome::LOG_LEVEL_WARN, tag, __VA_ARGS__)
+#define ESP_LOGI(tag, ...) ESPHOME_LOG_(::esphome::LOG_LEVEL_INFO, tag, __VA_ARGS__)
+#define ESP_LOGCONFIG(tag, ...) ESPHOME_LOG_(::esphome::LOG_LEVEL_CONFIG, tag, __VA_ARGS__)
+#define ESP_LOGD(tag, ...) ESPHOME_LOG_(::esphome::LOG_LEVEL_DEBUG, tag, __VA_ARGS__)
+#define ESP_LOGV(tag, ...) ESPHOME_LOG_(::esphome::LOG_LEVEL_VERBOSE, tag, __VA_ARGS__)
+#define ESP_LOGVV(tag, ...) ESPHOME_LOG_(::esphome::LOG_LEVEL_VERY_VERBOSE, tag, __VA_ARGS__)
+
+#define ESP_LOG_MSG_COMM_FAIL "Communication failed"
+
+#define LOG_UPDATE_INTERVAL(this) ESP_LOGCONFIG(TAG, "  Update Interval: %.1fs", (this)->get_update_interval() / 1000.0f)
+#define LOG_SENSOR(prefix, type, obj) \
+  if ((obj) != nullptr) { \
+    ESP_LOGCONFIG(TAG, "%s%s '%s'", prefix, type, (obj)->get_name().c_str()); \
+  }
+#define LOG_TEXT_SENSOR(prefix, type, obj) LOG_SENSOR(prefix, type, obj)
+#define LOG_I2C_DEVICE(this) ESP_LOGCONFIG(TAG, "  Address: 0x%02X", (this)->get_i2c_address())
@@ -0,0 +1,10 @@
+#pragma once
+
+#include <optional>
+
+namespace esphome {
+
+template<typename T> using optional = std::optional<T>;
+using std::nullopt;
+
+}  // namespace esphome
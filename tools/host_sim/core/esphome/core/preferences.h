@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace esphome {
+
+// In-memory preference slot; survives simulated reboots of the harness, not the process.
+class ESPPreferenceObject {
+ public:
+  ESPPreferenceObject() = default;
+  ESPPreferenceObject(std::vector<uint8_t> *data) : data_(data) {}
+
+  template<typename T> bool save(const T *src) {
+    if (this->data_ == nullptr) {
+      return false;
+    }
+    this->data_->assign(reinterpret_cast<const uint8_t *>(src), reinterpret_cast<const uint8_t *>(src) + sizeof(T));
+    return true;
+  }
+  template<typename T> bool load(T *dest) {
+    if (this->data_ == nullptr || this->data_->size() != sizeof(T)) {
+      return false;
+    }
+    memcpy(dest, this->data_->data(), sizeof(T));
+    return true;
+  }
+
+ protected:
+  std::vector<uint8_t> *data_{nullptr};
+};
+
+class ESPPreferences {
+ public:
+  virtual ~ESPPreferences() = default;
+  virtual ESPPreferenceObject make_preference(size_t length, uint32_t type, bool in_flash) = 0;
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type, bool in_flash) {
+    return this->make_preference(sizeof(T), type, in_flash);
+  }
+  template<typename T> ESPPreferenceObject make_preference(uint32_t type) { return this->make_preference<T>(type, false); }
+  virtual bool sync() { return true; }
+};
+
+extern ESPPreferences *global_preferences;
+
+namespace host_sim {
+
+// forgets RTC slots and keeps flash ones, like a power loss of the firmware
+void clear_rtc_preferences();
+
+}  // namespace host_sim
+
+}  // namespace esphome
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace esphome {
+
+class Component;
+
+// Named timeouts and intervals on the virtual clock. Items are due at a
+// 64 bit µs time, so runs longer than the millis() wrap keep their order.
+class Scheduler {
+ public:
+  void set_timeout(Component *component, const std::string &name, uint32_t timeout, std::function<void()> func);
+  bool cancel_timeout(Component *component, const std::string &name);
+  void set_interval(Component *component, const std::string &name, uint32_t interval, std::function<void()> func);
+  bool cancel_interval(Component *component, const std::string &name);
+  // drops everything of a failed component
+  void cancel_all(Component *component);
+
+  // time of the earliest item, UINT64_MAX when nothing is scheduled
+  uint64_t next_due_us() const;
+  // runs every item due at or before the current virtual time, in time order
+  void call();
+
+  uint64_t get_executed() const { return this->executed_; }
+
+ protected:
+  struct Item {
+    Component *component;
+    std::string name;
+    bool interval;
+    uint32_t period_ms;
+    uint64_t due_us;
+    // insertion order breaks ties between items due at the same time
+    uint64_t seq;
+    std::function<void()> func;
+    bool removed;
+  };
+
+  void add_(Component *component, const std::string &name, bool interval, uint32_t period_ms, std::function<void()> func);
+  bool cancel_(Component *component, const std::string &name, bool interval);
+  Item *next_() const;
+  void cleanup_();
+
+  std::vector<std::unique_ptr<Item>> items_;
+  uint64_t seq_{0};
+  uint64_t executed_{0};
+  uint32_t removed_count_{0};
+};
+
+}  // namespace esphome
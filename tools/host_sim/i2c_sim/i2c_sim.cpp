@@ -0,0 +1,100 @@
+#include "i2c_sim.h"
+#include "esphome/core/hal.h"
+#include "esphome/core/log.h"
+
+namespace esphome {
+namespace i2c_sim {
+
+static const char *const TAG = "i2c_sim";
+
+void I2CSimBus::setup() {
+  const int64_t now = this->now_us_();
+  for (auto *device : this->devices_) {
+    if (!device->trace_file_.empty() && !device->trace_.load(device->trace_file_)) {
+      ESP_LOGE(TAG, "0x%02X: %s", device->address_, device->trace_.get_error().c_str());
+      this->mark_failed();
+      return;
+    }
+    device->model_.reset(now);
+  }
+}
+
+void I2CSimBus::dump_config() {
+  ESP_LOGCONFIG(TAG, "Simulated I2C Bus:");
+  for (auto *device : this->devices_) {
+    ESP_LOGCONFIG(TAG, "  0x%02X: INA%s, %u trace points over %.3f s from '%s'", device->address_,
+                  device->model_.get_variant() == INA_VARIANT_219 ? "219" : "226", (unsigned) device->trace_.size(),
+                  device->trace_.duration_us() / 1e6, device->trace_file_.c_str());
+  }
+}
+
+InaSimDevice *I2CSimBus::find_(uint8_t address) {
+  for (auto *device : this->devices_) {
+    if (device->address_ == address) {
+      return device;
+    }
+  }
+  return nullptr;
+}
+
+int64_t I2CSimBus::now_us_() {
+  const uint32_t now = micros();
+  if (now < this->last_micros_) {
+    this->micros_high_ += int64_t(1) << 32;
+  }
+  this->last_micros_ = now;
+  return this->micros_high_ + now;
+}
+
+i2c::ErrorCode I2CSimBus::readv(uint8_t address, i2c::ReadBuffer *buffers, size_t cnt) {
+  InaSimDevice *device = this->find_(address);
+  if (device == nullptr) {
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  this->transactions_++;
+  // the INA repeats the pointed register MSB first for longer reads
+  const uint16_t value = device->model_.read_register(device->pointer_, this->now_us_());
+  size_t pos = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    for (size_t j = 0; j < buffers[i].len; j++, pos++) {
+      buffers[i].data[j] = (pos & 1) == 0 ? value >> 8 : value & 0xFF;
+    }
+  }
+  return i2c::ERROR_OK;
+}
+
+i2c::ErrorCode I2CSimBus::writev(uint8_t address, i2c::WriteBuffer *buffers, size_t cnt, bool stop) {
+  InaSimDevice *device = this->find_(address);
+  if (device == nullptr) {
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  this->transactions_++;
+  uint8_t bytes[3];
+  size_t len = 0;
+  for (size_t i = 0; i < cnt; i++) {
+    for (size_t j = 0; j < buffers[i].len; j++) {
+      if (len == sizeof(bytes)) {
+        return i2c::ERROR_TOO_LARGE;
+      }
+      bytes[len++] = buffers[i].data[j];
+    }
+  }
+  if (len == 0) {
+    return i2c::ERROR_OK;  // address probe
+  }
+  device->pointer_ = bytes[0];
+  if (len == 1) {
+    return i2c::ERROR_OK;
+  }
+  if (len != 3) {
+    return i2c::ERROR_INVALID_ARGUMENT;
+  }
+  const uint16_t value = (uint16_t(bytes[1]) << 8) | bytes[2];
+  if (!device->model_.write_register(bytes[0], value, this->now_us_())) {
+    return i2c::ERROR_NOT_ACKNOWLEDGED;
+  }
+  return i2c::ERROR_OK;
+}
+
+}  // namespace i2c_sim
+}  // namespace esphome
@@ -0,0 +1,67 @@
+#pragma once
+
+#include "esphome/core/component.h"
+#include "esphome/components/i2c/i2c_bus.h"
+#include "ina_model.h"
+#include "trace.h"
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace i2c_sim {
+
+// An INA219/INA226 on the simulated bus, replaying a trace file.
+class InaSimDevice {
+ public:
+  InaSimDevice(uint8_t address, InaVariant variant, float shunt_resistance_ohm)
+      : address_(address), model_(variant, shunt_resistance_ohm) {
+    this->model_.set_trace(&this->trace_);
+  }
+
+  void set_trace_file(const std::string &path) { this->trace_file_ = path; }
+  void set_loop(bool loop) { this->trace_.set_loop(loop); }
+  void set_interpolate(bool interpolate) { this->trace_.set_interpolate(interpolate); }
+
+  uint8_t get_address() const { return this->address_; }
+  InaModel &get_model() { return this->model_; }
+  Trace &get_trace() { return this->trace_; }
+
+ protected:
+  friend class I2CSimBus;
+
+  uint8_t address_;
+  // register pointer, set by the first byte of every write
+  uint8_t pointer_{0};
+  InaModel model_;
+  Trace trace_;
+  std::string trace_file_;
+};
+
+// I2C bus of the host harness. Register pointer writes, 16 bit register
+// writes and reads are routed to the simulated devices, other addresses NACK.
+class I2CSimBus : public i2c::I2CBus, public Component {
+ public:
+  void setup() override;
+  void dump_config() override;
+  float get_setup_priority() const override { return setup_priority::BUS; }
+
+  void add_device(InaSimDevice *device) { this->devices_.push_back(device); }
+
+  i2c::ErrorCode readv(uint8_t address, i2c::ReadBuffer *buffers, size_t cnt) override;
+  i2c::ErrorCode writev(uint8_t address, i2c::WriteBuffer *buffers, size_t cnt, bool stop) override;
+
+  uint32_t get_transactions() const { return this->transactions_; }
+
+ protected:
+  InaSimDevice *find_(uint8_t address);
+  // micros() extended to 64 bit, traces may run longer than its wrap
+  int64_t now_us_();
+
+  std::vector<InaSimDevice *> devices_;
+  uint32_t last_micros_{0};
+  int64_t micros_high_{0};
+  uint32_t transactions_{0};
+};
+
+}  // namespace i2c_sim
+}  // namespace esphome
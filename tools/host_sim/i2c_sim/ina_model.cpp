@@ -0,0 +1,267 @@
+#include "ina_model.h"
+#include <cmath>
+#include <cstdlib>
+
+namespace esphome {
+namespace i2c_sim {
+
+static const uint8_t REG_CONFIG = 0x00;
+static const uint8_t REG_SHUNT_VOLTAGE = 0x01;
+static const uint8_t REG_BUS_VOLTAGE = 0x02;
+static const uint8_t REG_POWER = 0x03;
+static const uint8_t REG_CURRENT = 0x04;
+static const uint8_t REG_CALIBRATION = 0x05;
+// INA226 only
+static const uint8_t REG_MASK_ENABLE = 0x06;
+static const uint8_t REG_ALERT_LIMIT = 0x07;
+static const uint8_t REG_MANUFACTURER_ID = 0xFE;
+static const uint8_t REG_DIE_ID = 0xFF;
+
+static const uint16_t INA219_CONFIG_DEFAULT = 0x399F;
+static const uint16_t INA226_CONFIG_DEFAULT = 0x4127;
+static const uint16_t CONFIG_RESET = 0x8000;
+
+static const uint16_t INA226_MASK_CVRF = 0x0008;
+static const uint16_t INA226_MASK_OVF = 0x0004;
+static const uint16_t INA219_BUS_CNVR = 0x0002;
+static const uint16_t INA219_BUS_OVF = 0x0001;
+
+static const uint16_t INA219_ADC_US[] = {84, 148, 276, 532};
+static const uint16_t INA226_ADC_US[] = {140, 204, 332, 588, 1100, 2116, 4156, 8244};
+static const uint16_t INA226_AVG_SAMPLES[] = {1, 4, 16, 64, 128, 256, 512, 1024};
+
+// BADC/SADC: 0b0X.. single sample of 9..12 bit, 0b1nnn 2^n 12 bit samples
+static void ina219_adc(uint8_t adc, uint32_t *sample_us, uint16_t *samples) {
+  if ((adc & 0x08) == 0) {
+    *sample_us = INA219_ADC_US[adc & 0x03];
+    *samples = 1;
+  } else {
+    *sample_us = INA219_ADC_US[3];
+    *samples = 1 << (adc & 0x07);
+  }
+}
+
+static int32_t clamp_i32(int64_t value, int32_t min, int32_t max) {
+  return value < min ? min : (value > max ? max : (int32_t) value);
+}
+
+void InaModel::reset(int64_t now_us) {
+  this->epoch_us_ = now_us;
+  this->config_ = this->variant_ == INA_VARIANT_219 ? INA219_CONFIG_DEFAULT : INA226_CONFIG_DEFAULT;
+  this->calibration_ = 0;
+  this->shunt_ = 0;
+  this->bus_ = 0;
+  this->power_ = 0;
+  this->current_ = 0;
+  this->mask_enable_ = 0;
+  this->alert_limit_ = 0;
+  this->conversion_ready_ = false;
+  this->overflow_ = false;
+  this->start_(now_us);
+}
+
+InaModel::Timing InaModel::timing_() const {
+  Timing timing;
+  if (this->variant_ == INA_VARIANT_219) {
+    ina219_adc((this->config_ >> 3) & 0x0F, &timing.shunt_us, &timing.shunt_samples);
+    ina219_adc((this->config_ >> 7) & 0x0F, &timing.bus_us, &timing.bus_samples);
+  } else {
+    timing.shunt_us = INA226_ADC_US[(this->config_ >> 3) & 0x07];
+    timing.bus_us = INA226_ADC_US[(this->config_ >> 6) & 0x07];
+    timing.shunt_samples = timing.bus_samples = INA226_AVG_SAMPLES[(this->config_ >> 9) & 0x07];
+  }
+  // shunt or bus only modes skip the other conversion
+  if ((this->mode_() & 0x01) == 0) {
+    timing.shunt_samples = 0;
+  }
+  if ((this->mode_() & 0x02) == 0) {
+    timing.bus_samples = 0;
+  }
+  return timing;
+}
+
+uint32_t InaModel::get_cycle_us() const {
+  const Timing timing = this->timing_();
+  return timing.shunt_us * timing.shunt_samples + timing.bus_us * timing.bus_samples;
+}
+
+void InaModel::start_(int64_t now_us) {
+  // 0 power-down, 4 ADC off, 1..3 triggered, 5..7 continuous
+  this->converting_ = (this->mode_() & 0x03) != 0;
+  this->cycle_start_us_ = now_us;
+}
+
+void InaModel::update_(int64_t now_us) {
+  if (!this->converting_) {
+    return;
+  }
+  const uint32_t cycle = this->get_cycle_us();
+  if (cycle == 0 || now_us < this->cycle_start_us_ + cycle) {
+    return;
+  }
+  // only the last finished cycle is visible in the registers
+  const int64_t cycles = (now_us - this->cycle_start_us_) / cycle;
+  this->convert_(this->cycle_start_us_ + (cycles - 1) * cycle);
+  this->conversions_ += cycles;
+  if ((this->mode_() & 0x04) == 0) {
+    this->converting_ = false;  // triggered: one conversion
+  }
+  this->cycle_start_us_ += cycles * cycle;
+}
+
+TracePoint InaModel::sample_(int64_t time_us) {
+  if (this->trace_ == nullptr) {
+    return {time_us, 0, 0};
+  }
+  return this->trace_->sample(time_us - this->epoch_us_);
+}
+
+void InaModel::convert_(int64_t start_us) {
+  const Timing timing = this->timing_();
+  // INA226 alternates shunt and bus samples, the INA219 ADCs run one after the other
+  const bool interleaved = this->variant_ == INA_VARIANT_226;
+  int64_t shunt_sum = 0;
+  int64_t bus_sum = 0;
+  const double shunt_lsb = this->variant_ == INA_VARIANT_219 ? 10e-6 : 2.5e-6;
+  const double bus_lsb = this->variant_ == INA_VARIANT_219 ? 4e-3 : 1.25e-3;
+
+  for (uint16_t i = 0; i < timing.shunt_samples; i++) {
+    const int64_t offset = interleaved ? i * int64_t(timing.shunt_us + timing.bus_us) : i * int64_t(timing.shunt_us);
+    const TracePoint point = this->sample_(start_us + offset + timing.shunt_us / 2);
+    shunt_sum += std::lround(point.current_a * this->shunt_ohm_ / shunt_lsb);
+  }
+  for (uint16_t i = 0; i < timing.bus_samples; i++) {
+    const int64_t offset = interleaved ? i * int64_t(timing.shunt_us + timing.bus_us) + timing.shunt_us
+                                       : timing.shunt_samples * int64_t(timing.shunt_us) + i * int64_t(timing.bus_us);
+    const TracePoint point = this->sample_(start_us + offset + timing.bus_us / 2);
+    bus_sum += std::lround(point.voltage_v / bus_lsb);
+  }
+
+  if (timing.shunt_samples != 0) {
+    int32_t shunt = shunt_sum / timing.shunt_samples;
+    if (this->variant_ == INA_VARIANT_219) {
+      // PGA range 40 mV << PG, fewer ADC bits drop low bits
+      const int32_t range = 4000 << ((this->config_ >> 11) & 0x03);
+      shunt = clamp_i32(shunt, -range, range);
+      const uint8_t sadc = (this->config_ >> 3) & 0x0F;
+      if ((sadc & 0x08) == 0) {
+        const int32_t step = 1 << (3 - (sadc & 0x03));
+        shunt = shunt / step * step;
+      }
+    } else {
+      shunt = clamp_i32(shunt, INT16_MIN, INT16_MAX);
+    }
+    this->shunt_ = (uint16_t) (int16_t) shunt;
+  }
+  if (timing.bus_samples != 0) {
+    int32_t bus = bus_sum / timing.bus_samples;
+    if (this->variant_ == INA_VARIANT_219) {
+      // BRNG 16 V or 32 V, the register has 13 bits either way
+      const int32_t range = (this->config_ & 0x2000) != 0 ? 8000 : 4000;
+      bus = clamp_i32(bus, 0, range);
+    } else {
+      bus = clamp_i32(bus, 0, 0x7FFF);
+    }
+    this->bus_ = bus;
+  }
+  this->compute_();
+  this->conversion_ready_ = true;
+}
+
+void InaModel::compute_() {
+  // datasheet current and power formulas, truncated like the device
+  const int16_t shunt = (int16_t) this->shunt_;
+  const int64_t divider = this->variant_ == INA_VARIANT_219 ? 4096 : 2048;
+  const uint16_t calibration = this->variant_ == INA_VARIANT_219 ? this->calibration_ & 0xFFFE : this->calibration_ & 0x7FFF;
+  const int64_t current = int64_t(shunt) * calibration / divider;
+  this->overflow_ = current > INT16_MAX || current < INT16_MIN;
+  this->current_ = (uint16_t) (int16_t) clamp_i32(current, INT16_MIN, INT16_MAX);
+
+  const int64_t power_divider = this->variant_ == INA_VARIANT_219 ? 5000 : 20000;
+  const int64_t power = std::llabs(int64_t((int16_t) this->current_)) * this->bus_ / power_divider;
+  this->overflow_ = this->overflow_ || power > UINT16_MAX;
+  this->power_ = power > UINT16_MAX ? UINT16_MAX : (uint16_t) power;
+}
+
+uint16_t InaModel::read_register(uint8_t reg, int64_t now_us) {
+  this->update_(now_us);
+  switch (reg) {
+    case REG_CONFIG:
+      return this->config_;
+    case REG_SHUNT_VOLTAGE:
+      return this->shunt_;
+    case REG_BUS_VOLTAGE:
+      if (this->variant_ == INA_VARIANT_219) {
+        return (this->bus_ << 3) | (this->conversion_ready_ ? INA219_BUS_CNVR : 0) | (this->overflow_ ? INA219_BUS_OVF : 0);
+      }
+      return this->bus_;
+    case REG_POWER:
+      if (this->variant_ == INA_VARIANT_219) {
+        this->conversion_ready_ = false;
+      }
+      return this->power_;
+    case REG_CURRENT:
+      return this->current_;
+    case REG_CALIBRATION:
+      return this->calibration_;
+    default:
+      break;
+  }
+  if (this->variant_ != INA_VARIANT_226) {
+    return 0xFFFF;
+  }
+  switch (reg) {
+    case REG_MASK_ENABLE: {
+      const uint16_t value =
+          this->mask_enable_ | (this->conversion_ready_ ? INA226_MASK_CVRF : 0) | (this->overflow_ ? INA226_MASK_OVF : 0);
+      this->conversion_ready_ = false;
+      return value;
+    }
+    case REG_ALERT_LIMIT:
+      return this->alert_limit_;
+    case REG_MANUFACTURER_ID:
+      return 0x5449;
+    case REG_DIE_ID:
+      return 0x2260;
+    default:
+      return 0xFFFF;
+  }
+}
+
+bool InaModel::write_register(uint8_t reg, uint16_t value, int64_t now_us) {
+  this->update_(now_us);
+  switch (reg) {
+    case REG_CONFIG:
+      if ((value & CONFIG_RESET) != 0) {
+        const int64_t epoch = this->epoch_us_;
+        this->reset(now_us);
+        this->epoch_us_ = epoch;
+        return true;
+      }
+      this->config_ = value;
+      this->conversion_ready_ = false;
+      // a config write aborts the running conversion and starts over
+      this->start_(now_us);
+      return true;
+    case REG_CALIBRATION:
+      this->calibration_ = value;
+      this->compute_();
+      return true;
+    default:
+      break;
+  }
+  if (this->variant_ == INA_VARIANT_226) {
+    if (reg == REG_MASK_ENABLE) {
+      this->mask_enable_ = value & 0xFC03;
+      return true;
+    }
+    if (reg == REG_ALERT_LIMIT) {
+      this->alert_limit_ = value;
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace i2c_sim
+}  // namespace esphome
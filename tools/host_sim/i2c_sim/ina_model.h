@@ -0,0 +1,80 @@
+#pragma once
+
+// Plain C++, no ESPHome headers: usable by host tools without the virtual-clock core.
+#include <cstdint>
+#include "trace.h"
+
+namespace esphome {
+namespace i2c_sim {
+
+enum InaVariant : uint8_t {
+  INA_VARIANT_219,
+  INA_VARIANT_226,
+};
+
+// Register level model of an INA219/INA226 measuring a trace through a shunt.
+//
+// Conversions follow the configuration register: every ADC sample reads the
+// trace at the middle of its conversion time, the registers take the average
+// once all samples of a cycle are done and keep it until the next cycle ends,
+// so reading faster than the conversion rate returns repeated values like the
+// real part. Current and power come from the calibration register with the
+// datasheet formulas, including their integer truncation and overflow.
+class InaModel {
+ public:
+  InaModel(InaVariant variant, float shunt_resistance_ohm) : variant_(variant), shunt_ohm_(shunt_resistance_ohm) {}
+
+  void set_trace(Trace *trace) { this->trace_ = trace; }
+  // power-on state, time 0 of the trace is now_us
+  void reset(int64_t now_us);
+
+  uint16_t read_register(uint8_t reg, int64_t now_us);
+  // false for read-only or unknown registers (NACK on the bus)
+  bool write_register(uint8_t reg, uint16_t value, int64_t now_us);
+
+  InaVariant get_variant() const { return this->variant_; }
+  // duration of one full conversion cycle with the current configuration
+  uint32_t get_cycle_us() const;
+  uint32_t get_conversions() const { return this->conversions_; }
+
+ protected:
+  struct Timing {
+    uint32_t shunt_us;
+    uint16_t shunt_samples;
+    uint32_t bus_us;
+    uint16_t bus_samples;
+  };
+  Timing timing_() const;
+  uint8_t mode_() const { return this->config_ & 0x07; }
+
+  void start_(int64_t now_us);
+  void update_(int64_t now_us);
+  void convert_(int64_t start_us);
+  TracePoint sample_(int64_t time_us);
+  // current and power registers from shunt, bus and calibration
+  void compute_();
+
+  InaVariant variant_;
+  float shunt_ohm_;
+  Trace *trace_{nullptr};
+  int64_t epoch_us_{0};
+
+  uint16_t config_{0};
+  uint16_t calibration_{0};
+  uint16_t shunt_{0};
+  uint16_t bus_{0};
+  uint16_t power_{0};
+  uint16_t current_{0};
+  uint16_t mask_enable_{0};
+  uint16_t alert_limit_{0};
+
+  // start of the cycle in progress, cycles stop after a triggered conversion
+  int64_t cycle_start_us_{0};
+  bool converting_{false};
+  bool conversion_ready_{false};
+  bool overflow_{false};
+  uint32_t conversions_{0};
+};
+
+}  // namespace i2c_sim
+}  // namespace esphome
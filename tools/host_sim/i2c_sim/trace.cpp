@@ -0,0 +1,180 @@
+#include "trace.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+namespace esphome {
+namespace i2c_sim {
+
+static const char TRACE_MAGIC[8] = {'I', 'N', 'A', 'T', 'R', 'A', 'C', 'E'};
+
+bool Trace::load(const std::string &path) {
+  const size_t dot = path.rfind('.');
+  if (dot != std::string::npos && path.compare(dot, std::string::npos, ".csv") == 0) {
+    return this->load_csv(path);
+  }
+  return this->load_binary(path);
+}
+
+bool Trace::load_csv(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return this->fail_("cannot open " + path);
+  }
+  this->clear();
+  char line[256];
+  uint32_t line_no = 0;
+  bool ok = true;
+  while (fgets(line, sizeof(line), file) != nullptr) {
+    line_no++;
+    const char *pos = line;
+    while (*pos == ' ' || *pos == '\t') {
+      pos++;
+    }
+    if (*pos == '#' || *pos == '\n' || *pos == '\r' || *pos == '\0') {
+      continue;
+    }
+    char *end;
+    const double time_s = strtod(pos, &end);
+    if (end == pos) {
+      if (this->points_.empty() && line_no == 1) {
+        continue;  // header
+      }
+      ok = this->fail_(path + ":" + std::to_string(line_no) + ": expected time_s,current_a,voltage_v");
+      break;
+    }
+    float values[2];
+    for (float &value : values) {
+      pos = end;
+      while (*pos == ' ' || *pos == '\t' || *pos == ',' || *pos == ';') {
+        pos++;
+      }
+      value = strtof(pos, &end);
+      if (end == pos) {
+        ok = false;
+        break;
+      }
+    }
+    const int64_t time_us = (int64_t) (time_s * 1e6 + (time_s < 0 ? -0.5 : 0.5));
+    if (!ok || (!this->points_.empty() && time_us < this->points_.back().time_us)) {
+      ok = this->fail_(path + ":" + std::to_string(line_no) + ": malformed or out of order point");
+      break;
+    }
+    this->add(time_us, values[0], values[1]);
+  }
+  fclose(file);
+  if (ok && this->points_.empty()) {
+    ok = this->fail_(path + ": no points");
+  }
+  return ok;
+}
+
+bool Trace::load_binary(const std::string &path) {
+  FILE *file = fopen(path.c_str(), "rb");
+  if (file == nullptr) {
+    return this->fail_("cannot open " + path);
+  }
+  this->clear();
+  char magic[sizeof(TRACE_MAGIC)];
+  if (fread(magic, 1, sizeof(magic), file) != sizeof(magic) || memcmp(magic, TRACE_MAGIC, sizeof(magic)) != 0) {
+    fclose(file);
+    return this->fail_(path + ": not a binary trace");
+  }
+  // records are little-endian, as are all hosts this runs on
+  uint8_t record[16];
+  while (fread(record, 1, sizeof(record), file) == sizeof(record)) {
+    TracePoint point;
+    memcpy(&point.time_us, record, 8);
+    memcpy(&point.current_a, record + 8, 4);
+    memcpy(&point.voltage_v, record + 12, 4);
+    if (!this->points_.empty() && point.time_us < this->points_.back().time_us) {
+      fclose(file);
+      return this->fail_(path + ": out of order point at " + std::to_string(this->points_.size()));
+    }
+    this->points_.push_back(point);
+  }
+  fclose(file);
+  if (this->points_.empty()) {
+    return this->fail_(path + ": no points");
+  }
+  return true;
+}
+
+bool Trace::save_binary(const std::string &path) const {
+  FILE *file = fopen(path.c_str(), "wb");
+  if (file == nullptr) {
+    return false;
+  }
+  bool ok = fwrite(TRACE_MAGIC, 1, sizeof(TRACE_MAGIC), file) == sizeof(TRACE_MAGIC);
+  for (const auto &point : this->points_) {
+    uint8_t record[16];
+    memcpy(record, &point.time_us, 8);
+    memcpy(record + 8, &point.current_a, 4);
+    memcpy(record + 12, &point.voltage_v, 4);
+    ok = ok && fwrite(record, 1, sizeof(record), file) == sizeof(record);
+  }
+  return fclose(file) == 0 && ok;
+}
+
+void Trace::add(int64_t time_us, float current_a, float voltage_v) {
+  this->points_.push_back({time_us, current_a, voltage_v});
+}
+
+void Trace::clear() {
+  this->points_.clear();
+  this->cursor_ = 0;
+  this->error_.clear();
+}
+
+int64_t Trace::duration_us() const {
+  if (this->points_.size() < 2) {
+    return 0;
+  }
+  return this->points_.back().time_us - this->points_.front().time_us;
+}
+
+TracePoint Trace::sample(int64_t time_us) {
+  if (this->points_.empty()) {
+    return {time_us, 0, 0};
+  }
+  const int64_t start = this->points_.front().time_us;
+  int64_t t = start + time_us;
+  if (this->loop_ && this->points_.size() > 1) {
+    // the last point lasts as long as the step before it, then the first one follows
+    const size_t last = this->points_.size() - 1;
+    const int64_t period = this->duration_us() + this->points_[last].time_us - this->points_[last - 1].time_us;
+    if (period > 0 && t >= start + period) {
+      t = start + (t - start) % period;
+    }
+  }
+
+  // move the cursor to the last point at or before t, mostly a step forward;
+  // the model samples shunt and bus of a cycle out of order, so search going back
+  if (this->cursor_ >= this->points_.size() || this->points_[this->cursor_].time_us > t) {
+    auto it = std::upper_bound(this->points_.begin(), this->points_.end(), t,
+                               [](int64_t time_us, const TracePoint &point) { return time_us < point.time_us; });
+    this->cursor_ = it == this->points_.begin() ? 0 : it - this->points_.begin() - 1;
+  }
+  while (this->cursor_ + 1 < this->points_.size() && this->points_[this->cursor_ + 1].time_us <= t) {
+    this->cursor_++;
+  }
+
+  TracePoint point = this->points_[this->cursor_];
+  if (this->interpolate_ && t > point.time_us && this->cursor_ + 1 < this->points_.size()) {
+    const TracePoint &next = this->points_[this->cursor_ + 1];
+    const float f = float(t - point.time_us) / float(next.time_us - point.time_us);
+    point.current_a += (next.current_a - point.current_a) * f;
+    point.voltage_v += (next.voltage_v - point.voltage_v) * f;
+  }
+  point.time_us = time_us;
+  return point;
+}
+
+bool Trace::fail_(const std::string &error) {
+  this->error_ = error;
+  return false;
+}
+
+}  // namespace i2c_sim
+}  // namespace esphome
@@ -0,0 +1,62 @@
+#pragma once
+
+// Plain C++, no ESPHome headers: usable by host tools without the virtual-clock core.
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace esphome {
+namespace i2c_sim {
+
+struct TracePoint {
+  int64_t time_us;
+  float current_a;
+  float voltage_v;
+};
+
+// Recorded or synthetic current/voltage waveform, replayed against a clock
+// that starts at 0 with the replay.
+//
+// CSV: one "time_s,current_a,voltage_v" line per point, '#' comments and a
+// non-numeric header line are skipped.
+// Binary: the 8 byte magic "INATRACE" followed by little-endian records of
+// int64 time_us, float current_a, float voltage_v.
+class Trace {
+ public:
+  // picks the format by the ".csv" extension
+  bool load(const std::string &path);
+  bool load_csv(const std::string &path);
+  bool load_binary(const std::string &path);
+  bool save_binary(const std::string &path) const;
+
+  // points have to be added in time order
+  void add(int64_t time_us, float current_a, float voltage_v);
+  void clear();
+
+  // start over at the first point, one step after the last one
+  void set_loop(bool loop) { this->loop_ = loop; }
+  // interpolate between points instead of holding the previous value
+  void set_interpolate(bool interpolate) { this->interpolate_ = interpolate; }
+
+  bool empty() const { return this->points_.empty(); }
+  size_t size() const { return this->points_.size(); }
+  int64_t duration_us() const;
+  const std::string &get_error() const { return this->error_; }
+
+  // value at time_us since the start of the replay; before the first point
+  // the first one applies, after the last one it holds unless looping.
+  // Lookups with increasing time are O(1) amortized.
+  TracePoint sample(int64_t time_us);
+
+ protected:
+  bool fail_(const std::string &error);
+
+  std::vector<TracePoint> points_;
+  size_t cursor_{0};
+  bool loop_{false};
+  bool interpolate_{false};
+  std::string error_;
+};
+
+}  // namespace i2c_sim
+}  // namespace esphome
@@ -0,0 +1,241 @@
+// Runs the charger and coulomb meter against a battery model on a virtual clock.
+// Time jumps from one scheduler item to the next, a simulated year takes seconds.
+#include "battery_model.h"
+#include "esphome/core/application.h"
+#include "esphome/core/log.h"
+#include "battery_charger/battery_charger.h"
+#include "coulomb_meter/coulomb_meter.h"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+
+namespace esphome {
+namespace host_sim {
+
+static const char *const TAG = "host_sim";
+
+static const uint64_t SECOND_US = 1000000;
+static const uint64_t HOUR_US = 3600 * SECOND_US;
+static const uint64_t DAY_US = 24 * HOUR_US;
+
+// 100 Ah flooded lead acid, 6 cells
+static const BatteryConfig BATTERY{100.0f, 6, 1.95f, 2.12f, 0.9f, 2.45f, 0.02f, 11.8f};
+static const float CHARGER_LIMIT_A = 20.0f;
+
+static const battery_charger::ChargeProfile PROFILE{
+    13.6f,           // float
+    14.4f,           // absorption
+    12.6f,           // absorption restart
+    2.0f,            // absorption current
+    2 * 3600,        // absorption time
+    7 * 86400,       // absorption restart time
+    600,             // absorption low voltage delay
+    14.8f,           // equalization
+    2 * 3600,        // equalization time
+    10 * 86400,      // equalization interval
+    4 * 3600,        // equalization timeout
+    15.5f,           // max voltage
+    10.5f,           // min voltage
+    60,              // voltage auto recovery delay
+    6,               // cells
+    0,               // temperature compensation
+    25,              // temperature reference
+    NAN,             // min charge temperature
+    NAN,             // max charge temperature
+};
+
+// Counts the model current like an INA would, without the bus.
+class SimCoulombMeter : public coulomb_meter::CoulombMeter {
+ public:
+  explicit SimCoulombMeter(BatteryModel *battery) : battery_(battery) {}
+
+  void integrate(float dt_s) {
+    const double delta_mc = this->battery_->get_current() * dt_s * 1000.0;
+    this->charge_mc_ += delta_mc;
+    this->energy_mj_ += this->battery_->get_voltage() * delta_mc;
+  }
+
+  void update() override {}
+  float get_voltage() override { return this->battery_->get_voltage(); }
+  float get_current() override { return this->battery_->get_current(); }
+  int64_t get_charge_c() override { return (int64_t) (this->charge_mc_ / 1000); }
+  int64_t get_energy_j() override { return (int64_t) (this->energy_mj_ / 1000); }
+
+ protected:
+  BatteryModel *battery_;
+  double charge_mc_{0};
+  double energy_mj_{0};
+};
+
+struct Options {
+  uint32_t days{365};
+  // battery model step and sensor publish period
+  float step_s{1.0f};
+  uint32_t publish_s{10};
+  // every outage_days the mains fail until the load is disconnected, 0 disables
+  uint32_t outage_days{30};
+};
+
+// Household style load: small base load, more in the evening.
+static float scripted_load(uint64_t now_us) {
+  const uint32_t hour = (now_us % DAY_US) / HOUR_US;
+  return hour >= 18 && hour < 23 ? 4.0f : 0.5f;
+}
+
+static int run(const Options &options) {
+  BatteryModel battery(BATTERY);
+  battery.set_soc(0.6f);
+
+  sensor::Sensor voltage("Battery Voltage");
+  sensor::Sensor current("Battery Current");
+  sensor::Sensor target("Target Voltage");
+  sensor::Sensor capacity("Calculated Capacity");
+  text_sensor::TextSensor state("Charge State");
+
+  SimCoulombMeter meter(&battery);
+  meter.set_update_interval(60000);
+  meter.set_fully_charge_voltage(14.3f);
+  meter.set_fully_charge_current(2.5f);
+  meter.set_fully_charge_time(600);
+  meter.set_fully_discharge_voltage(11.85f);
+  meter.set_fully_discharge_time(60);
+  meter.set_full_capacity(BATTERY.capacity_ah);
+  meter.set_full_energy(BATTERY.capacity_ah * 12.0f);
+  meter.set_charge_calculated_sensor(&capacity);
+
+  battery_charger::ChargerComponent charger;
+  charger.set_profile(PROFILE);
+  charger.set_voltage_sensor(&voltage);
+  charger.set_current_sensor(&current);
+  charger.set_voltage_target_sensor(&target);
+  charger.set_charge_state_sensor(&state);
+  charger.set_coulomb_meter(&meter);
+
+  // the charger output is the model source, it follows every new setpoint
+  target.add_on_state_callback([&battery](float voltage) { battery.set_charger(voltage, CHARGER_LIMIT_A); });
+  std::map<std::string, uint32_t> states;
+  state.add_on_state_callback([&states](const std::string &value) { states[value]++; });
+
+  App.register_component(&meter);
+  App.register_component(&charger);
+  App.setup();
+  if (log_level >= LOG_LEVEL_CONFIG) {
+    App.dump_config();
+  }
+
+  const auto wall_start = std::chrono::steady_clock::now();
+  const uint64_t end_us = uint64_t(options.days) * DAY_US;
+  const uint64_t step_us = uint64_t(options.step_s * SECOND_US);
+  const uint64_t publish_us = uint64_t(options.publish_s) * SECOND_US;
+  uint64_t next_publish_us = 0;
+  uint32_t outages = 0;
+  // outages that ran the battery down to the load disconnect
+  uint32_t discharges = 0;
+  bool outage = false;
+  float min_voltage = INFINITY;
+  float max_voltage = 0;
+
+  for (uint64_t now = 0; now < end_us; now += step_us) {
+    const uint64_t day = now / DAY_US;
+    const bool morning = now % DAY_US == 6 * HOUR_US;
+    if (options.outage_days != 0 && morning) {
+      if (!outage && day % options.outage_days == options.outage_days - 1) {
+        outage = true;
+        outages++;
+        ESP_LOGI(TAG, "Mains outage %u starts", outages);
+      } else if (outage && !battery.is_load_connected()) {
+        outage = false;
+        discharges++;
+      }
+      battery.set_mains(!outage);
+    }
+    battery.set_load(scripted_load(now));
+    battery.step(options.step_s);
+    meter.integrate(options.step_s);
+    min_voltage = std::min(min_voltage, battery.get_voltage());
+    max_voltage = std::max(max_voltage, battery.get_voltage());
+
+    if (now >= next_publish_us) {
+      next_publish_us += publish_us;
+      current.publish_state(battery.get_current());
+      voltage.publish_state(battery.get_voltage());
+    }
+    App.run_until_us(now + step_us);
+  }
+  App.shutdown();
+
+  const double wall_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall_start).count();
+  const double sim_s = end_us / 1e6;
+  printf("Simulated %u days in %.2f s (%.0fx real time)\n", options.days, wall_s, sim_s / wall_s);
+  printf("  Scheduler items run: %" PRIu64 ", sensor publishes: %u\n", App.scheduler.get_executed(),
+         voltage.get_publishes() + current.get_publishes());
+  printf("  Battery voltage range: %.2f .. %.2f V, final state of charge %.1f %%\n", min_voltage, max_voltage,
+         battery.get_soc() * 100);
+  printf("  Mains outages: %u, down to the load disconnect: %u\n", outages, discharges);
+  printf("  Charge states entered:");
+  for (auto &it : states) {
+    printf(" %s %u", it.first.c_str(), it.second);
+  }
+  printf("\n");
+  printf("  Learned capacity: %.1f Ah (nominal %.0f Ah)\n", capacity.state, BATTERY.capacity_ah);
+
+  int failures = 0;
+  // the interval timer restarts after every equalization, which takes up to its timeout
+  const uint32_t expected_equalizations =
+      uint32_t(options.days * 86400ULL / (PROFILE.equalization_interval_s + PROFILE.equalization_timeout_s));
+  if (states["equalization"] < expected_equalizations) {
+    printf("FAIL: %u equalizations, expected at least %u\n", states["equalization"], expected_equalizations);
+    failures++;
+  }
+  if (states["ERROR"] != 0) {
+    printf("FAIL: charger entered ERROR %u times\n", states["ERROR"]);
+    failures++;
+  }
+  if (discharges != 0) {
+    // usable charge between the meter's full mark (absorption tail) and its discharge voltage
+    if (std::isnan(capacity.state) || capacity.state < 0.6f * BATTERY.capacity_ah || capacity.state > BATTERY.capacity_ah) {
+      printf("FAIL: learned capacity %.1f Ah is implausible\n", capacity.state);
+      failures++;
+    }
+  }
+  printf(failures == 0 ? "PASS\n" : "FAILED\n");
+  return failures == 0 ? 0 : 1;
+}
+
+static void usage(const char *name) {
+  printf("Usage: %s [--days N] [--step SECONDS] [--publish SECONDS] [--outage-days N] [-v|-vv]\n", name);
+}
+
+}  // namespace host_sim
+}  // namespace esphome
+
+int main(int argc, char **argv) {
+  using namespace esphome;
+  host_sim::Options options;
+  log_level = LOG_LEVEL_WARN;
+  for (int i = 1; i < argc; i++) {
+    const bool has_value = i + 1 < argc;
+    if (strcmp(argv[i], "--days") == 0 && has_value) {
+      options.days = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--step") == 0 && has_value) {
+      options.step_s = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--publish") == 0 && has_value) {
+      options.publish_s = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "--outage-days") == 0 && has_value) {
+      options.outage_days = atoi(argv[++i]);
+    } else if (strcmp(argv[i], "-v") == 0) {
+      log_level = LOG_LEVEL_DEBUG;
+    } else if (strcmp(argv[i], "-vv") == 0) {
+      log_level = LOG_LEVEL_VERBOSE;
+    } else {
+      host_sim::usage(argv[0]);
+      return 2;
+    }
+  }
+  if (options.days == 0 || options.step_s <= 0 || options.publish_s == 0) {
+    host_sim::usage(argv[0]);
+    return 2;
+  }
+  return host_sim::run(options);
+}
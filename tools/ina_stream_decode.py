@@ -0,0 +1,162 @@
+#!/usr/bin/env python3
+"""Decodes the sample stream of an INA driver (`stream:` in its config) to CSV.
+
+    tools/ina_stream_decode.py /dev/ttyUSB0 --baud 921600 > samples.csv
+    tools/ina_stream_decode.py capture.bin > samples.csv
+
+Reads a serial port (needs pyserial) or a file with the raw bytes, and writes
+`time_s,current_a,voltage_v` rows. Until the first info frame the values are
+raw register steps. Dropped records, CRC errors and lost frames go to stderr.
+The frame layout is documented in components/coulomb_meter/sample_stream.h.
+"""
+
+import argparse
+import struct
+import sys
+
+SYNC = b"\xa5\x5a"
+FRAME_SAMPLES = 0
+FRAME_INFO = 1
+
+
+def crc16_ccitt(data):
+    crc = 0xFFFF
+    for byte in data:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else crc << 1
+            crc &= 0xFFFF
+    return crc
+
+
+def read_varint(payload, pos):
+    value = 0
+    shift = 0
+    while True:
+        byte = payload[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        if not byte & 0x80:
+            return value, pos
+        shift += 7
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+def split_frames(buffer, stats):
+    """Yields the payloads of the complete frames in buffer, which keeps the rest."""
+    while True:
+        start = buffer.find(SYNC)
+        if start < 0:
+            # keep a trailing 0xA5, it may start the next sync
+            keep = 1 if buffer.endswith(SYNC[:1]) else 0
+            stats["skipped"] += len(buffer) - keep
+            del buffer[: len(buffer) - keep]
+            return
+        stats["skipped"] += start
+        del buffer[:start]
+        if len(buffer) < 3:
+            return
+        length = buffer[2]
+        if len(buffer) < 3 + length + 2:
+            return
+        crc = buffer[3 + length] | buffer[4 + length] << 8
+        if crc16_ccitt(buffer[2 : 3 + length]) != crc:
+            # not a frame or a damaged one, resync after this sync
+            stats["crc_errors"] += 1
+            del buffer[:1]
+            continue
+        payload = bytes(buffer[3 : 3 + length])
+        del buffer[: 3 + length + 2]
+        yield payload
+
+
+class Decoder:
+    def __init__(self, out):
+        self.out = out
+        self.current_lsb = None
+        self.voltage_lsb = None
+        self.sequence = None
+        self.time_base_us = 0
+        self.previous_time_us = None
+        self.stats = {"skipped": 0, "crc_errors": 0, "lost_frames": 0, "dropped": 0, "records": 0}
+
+    def feed_payload(self, payload):
+        if payload[0] == FRAME_INFO:
+            _, version, self.current_lsb, self.voltage_lsb = struct.unpack_from("<BBff", payload)
+            if version != 1:
+                print(f"unknown info version {version}", file=sys.stderr)
+        elif payload[0] == FRAME_SAMPLES:
+            self.decode_samples(payload)
+
+    def decode_samples(self, payload):
+        _, sequence, dropped, time_us, current, voltage = struct.unpack_from("<BBHIhh", payload)
+        if self.sequence is not None and sequence != (self.sequence + 1) & 0xFF:
+            self.stats["lost_frames"] += (sequence - self.sequence - 1) & 0xFF
+        self.sequence = sequence
+        if dropped:
+            self.stats["dropped"] += dropped
+            print(f"{dropped} records dropped before frame {sequence}", file=sys.stderr)
+        self.write(time_us, current, voltage)
+        pos = struct.calcsize("<BBHIhh")
+        while pos < len(payload):
+            delta_us, pos = read_varint(payload, pos)
+            delta_current, pos = read_varint(payload, pos)
+            delta_voltage, pos = read_varint(payload, pos)
+            time_us = (time_us + delta_us) & 0xFFFFFFFF
+            current += unzigzag(delta_current)
+            voltage += unzigzag(delta_voltage)
+            self.write(time_us, current, voltage)
+
+    def write(self, time_us, current, voltage):
+        # micros() wraps after 71 minutes
+        if self.previous_time_us is not None and time_us < self.previous_time_us:
+            self.time_base_us += 1 << 32
+        self.previous_time_us = time_us
+        time_s = (self.time_base_us + time_us) / 1e6
+        if self.current_lsb is None:
+            self.out.write(f"{time_s:.6f},{current},{voltage}\n")
+        else:
+            self.out.write(f"{time_s:.6f},{current * self.current_lsb:.6f},{voltage * self.voltage_lsb:.4f}\n")
+        self.stats["records"] += 1
+
+
+def open_source(args):
+    if args.baud is None:
+        return open(args.source, "rb")
+    try:
+        import serial  # pylint: disable=import-outside-toplevel
+    except ImportError:
+        sys.exit("reading a serial port needs pyserial: pip install pyserial")
+    return serial.Serial(args.source, args.baud, timeout=0.1)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="serial port or file with the raw stream")
+    parser.add_argument("--baud", type=int, help="read source as a serial port at this baud rate")
+    args = parser.parse_args()
+
+    decoder = Decoder(sys.stdout)
+    buffer = bytearray()
+    sys.stdout.write("time_s,current_a,voltage_v\n")
+    with open_source(args) as source:
+        try:
+            while True:
+                chunk = source.read(4096)
+                if not chunk:
+                    if args.baud is None:
+                        break
+                    continue
+                buffer += chunk
+                for payload in split_frames(buffer, decoder.stats):
+                    decoder.feed_payload(payload)
+        except KeyboardInterrupt:
+            pass
+    print(", ".join(f"{key}: {value}" for key, value in decoder.stats.items()), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()